@@ -0,0 +1,108 @@
+/*
+ * onAlarm() cost with many services
+ *
+ *   ./AlarmBench [--services 256] [--calls 20000]
+ *
+ * SIGALRM is blocked in every thread so the timer never runs onAlarm() on
+ * its own; the main thread calls it directly and times each call.
+ *
+ *   idle:    nothing is due (the common tick for slow services)
+ *   all-due: every service is released on every call (calls are one
+ *            period apart, untimed sleep in between)
+ */
+
+#include "Sequencer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static long long nowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void runScenario(const char* scenario, int services, int calls, std::chrono::microseconds period)
+{
+    MemoryConfig mem;
+    mem.lockMemory = false;          // 256 workers: keep the benchmark unprivileged
+    mem.workerStackSize = 64 * 1024;
+    mem.stackPrefaultBytes = 4 * 1024;
+
+    Sequencer seq;
+    seq.setMemoryConfig(mem);
+    for (int i = 0; i < services; i++)
+    {
+        seq.addService("svc" + std::to_string(i), [] {}, 0, -1, period);
+    }
+
+    // The timer is armed but its signal stays pending (blocked everywhere)
+    if (!seq.startServices(std::chrono::microseconds(1000)))
+    {
+        std::cerr << scenario << ": Sequencer did not start\n";
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // First call releases everything once; not part of the measurement
+    seq.onAlarm();
+
+    std::vector<long long> samples;
+    samples.reserve(static_cast<size_t>(calls));
+    for (int i = 0; i < calls; i++)
+    {
+        if (period < std::chrono::seconds(1)) std::this_thread::sleep_for(period);
+        long long t0 = nowNs();
+        seq.onAlarm();
+        samples.push_back(nowNs() - t0);
+    }
+    seq.stopServices();
+
+    std::sort(samples.begin(), samples.end());
+    long long total = 0;
+    for (long long s : samples) total += s;
+    printf("%s,%d,%d,%.1f,%lld,%lld,%lld\n", scenario, services, calls,
+           double(total) / double(samples.size()), samples[samples.size() / 2],
+           samples[samples.size() * 99 / 100], samples.back());
+}
+
+int main(int argc, char* argv[])
+{
+    int services = 256;
+    int calls = 20000;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--services") == 0)   services = std::atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--calls") == 0) calls = std::atoi(argv[i + 1]);
+        else
+        {
+            std::cerr << "unknown option " << argv[i] << "\n";
+            return 2;
+        }
+    }
+    if (services < 1 || calls < 1)
+    {
+        std::cerr << "need --services >= 1 and --calls >= 1\n";
+        return 2;
+    }
+
+    // Inherited by every worker thread created below
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGALRM);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    printf("scenario,services,calls,avg_ns,p50_ns,p99_ns,max_ns\n");
+    runScenario("idle", services, calls, std::chrono::hours(1));
+    runScenario("all-due", services, calls / 10 > 0 ? calls / 10 : 1, std::chrono::microseconds(500));
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Inter-service channel benchmarks
+ *
+ *   ./ChannelBench [--messages 1000000] [--releases 2000] [--period-us 1000]
+ *                  [--priority 90] [--cpu -1]
+ *
+ * Part 1 ("cost/..."): send + receive of one 64-byte message on one thread,
+ * per channel type. The price of a hop without any contention.
+ *
+ * Part 2 ("pipeline/..."): a three-stage pipeline under the real Sequencer:
+ *
+ *   sensor (periodic) --SpscChannel--> filter (triggered)
+ *                     --LatestChannel--> actuate (triggered)
+ *
+ * Each send releases the next stage. Printed: the latency of each hop (send
+ * -> receive), the release -> start delay of the triggered stages, and the
+ * end-to-end latency from the sensor's sample to the actuator's receive.
+ */
+
+#include "Sequencer.hpp"
+#include "Channel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+struct BenchConfig
+{
+    long long messages{1000000};
+    int releases{2000};
+    int periodUs{1000};
+    int priority{90};
+    int cpuAffinity{-1};
+};
+
+static long long nowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// One cache line of payload, stamped by the sensor
+struct Sample
+{
+    long long sampledNs{0};
+    long long seq{0};
+    double values[6]{};
+};
+
+static void printLatency(const char* label, const RTHistogram& hist, long long count, double avgNs, long long maxNs)
+{
+    printf("%-28s n=%-8lld avg=%8.2f p50=%8.2f p99=%8.2f p99.9=%8.2f max=%8.2f us\n", label, count, avgNs / 1e3,
+           std::min(hist.percentile(0.50), maxNs) / 1e3, std::min(hist.percentile(0.99), maxNs) / 1e3,
+           std::min(hist.percentile(0.999), maxNs) / 1e3, maxNs / 1e3);
+}
+
+static void printChannel(const char* label, const ChannelStats& st)
+{
+    printLatency(label, st.latencyHist, st.received.load(), st.avgLatencyNs(), st.maxLatencyNs.load());
+    if (st.dropped.load() > 0) printf("%-28s dropped=%lld\n", "", st.dropped.load());
+}
+
+////////////////////////////////////////////
+// Part 1: cost of a hop
+////////////////////////////////////////////
+
+template <typename Channel>
+static void benchCost(const char* label, Channel& ch, long long messages)
+{
+    Sample in, out;
+    long long start = nowNs();
+    for (long long i = 0; i < messages; i++)
+    {
+        in.seq = i;
+        ch.send(in);
+        ch.receive(out);
+    }
+    long long elapsed = nowNs() - start;
+    if (out.seq != messages - 1) printf("%s: lost messages\n", label);
+    printf("%-28s %8.1f ns per send + receive\n", label, double(elapsed) / double(messages));
+}
+
+////////////////////////////////////////////
+// Part 2: pipeline
+////////////////////////////////////////////
+
+static void benchPipeline(const BenchConfig& cfg)
+{
+    // Static storage for the rings, built before anything runs
+    static SpscChannel<Sample, 64> raw;
+    static LatestChannel<Sample> filtered;
+    static RTHistogram endToEnd;
+    static long long endToEndMax = 0, endToEndTotal = 0, endToEndCount = 0;
+
+    Sequencer seq;
+    seq.addService("sensor", [] {
+        static long long n = 0;
+        Sample s;
+        s.sampledNs = nowNs();
+        s.seq = n++;
+        for (int i = 0; i < 6; i++) s.values[i] = double((s.seq + i) % 7);
+        raw.send(s);
+    }, cfg.priority, cfg.cpuAffinity, std::chrono::microseconds(cfg.periodUs));
+
+    seq.addService("filter", [] {
+        static double state[6] = {};
+        Sample last;
+        bool any = false;
+        raw.drain([&](const Sample& s) {
+            for (int i = 0; i < 6; i++) state[i] = 0.875 * state[i] + 0.125 * s.values[i];
+            last = s;
+            any = true;
+        });
+        if (!any) return;
+        for (int i = 0; i < 6; i++) last.values[i] = state[i];
+        filtered.send(last);
+    }, cfg.priority - 1, cfg.cpuAffinity, std::chrono::microseconds(0));
+
+    seq.addService("actuate", [] {
+        Sample s;
+        if (!filtered.receive(s)) return;
+        long long latency = nowNs() - s.sampledNs;
+        endToEnd.add(latency);
+        endToEndMax = std::max(endToEndMax, latency);
+        endToEndTotal += latency;
+        endToEndCount++;
+    }, cfg.priority - 2, cfg.cpuAffinity, std::chrono::microseconds(0));
+
+    raw.setTrigger(seq.getTrigger("filter"));
+    filtered.setTrigger(seq.getTrigger("actuate"));
+    seq.watchChannel("raw", raw.stats);
+    seq.watchChannel("filtered", filtered.stats);
+
+    if (!seq.startServices(std::chrono::microseconds(cfg.periodUs)))
+    {
+        std::cerr << "pipeline: Sequencer did not start\n";
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(cfg.releases) * cfg.periodUs));
+    seq.stopServices();
+
+    printChannel("pipeline/hop sensor>filter", raw.stats);
+    printChannel("pipeline/hop filter>actuate", filtered.stats);
+    for (const char* name : {"filter", "actuate"})
+    {
+        const RTStatistics* st = seq.getStatistics(name);
+        std::string label = std::string("pipeline/start ") + name;
+        printLatency(label.c_str(), st->releaseJitterHist, st->count.load(), st->avgReleaseJitterNs(),
+                     st->maxReleaseJitterNs.load());
+    }
+    printLatency("pipeline/end-to-end", endToEnd, endToEndCount,
+                 endToEndCount > 0 ? double(endToEndTotal) / double(endToEndCount) : 0.0, endToEndMax);
+}
+
+static bool parseArgs(int argc, char* argv[], BenchConfig& cfg)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const char* val = argv[++i];
+
+        if (strcmp(arg, "--messages") == 0)        cfg.messages = std::atoll(val);
+        else if (strcmp(arg, "--releases") == 0)   cfg.releases = std::atoi(val);
+        else if (strcmp(arg, "--period-us") == 0)  cfg.periodUs = std::atoi(val);
+        else if (strcmp(arg, "--priority") == 0)   cfg.priority = std::atoi(val);
+        else if (strcmp(arg, "--cpu") == 0)        cfg.cpuAffinity = std::atoi(val);
+        else
+        {
+            std::cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (cfg.messages < 1 || cfg.releases < 1 || cfg.periodUs < 10)
+    {
+        std::cerr << "need --messages >= 1, --releases >= 1 and --period-us >= 10\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) return 2;
+
+    auto spsc = std::make_unique<SpscChannel<Sample, 1024>>();
+    auto mpsc = std::make_unique<MpscChannel<Sample, 1024>>();
+    auto latest = std::make_unique<LatestChannel<Sample>>();
+    benchCost("cost/spsc", *spsc, cfg.messages);
+    benchCost("cost/mpsc", *mpsc, cfg.messages);
+    benchCost("cost/latest", *latest, cfg.messages);
+
+    benchPipeline(cfg);
+    return 0;
+}
@@ -0,0 +1,543 @@
+/*
+ * Benchmark harness: every GPIO toggle method run under the Sequencer
+ *
+ *   ./GpioBench [--rates 10,100,1000,10000] [--duration-ms 2000]
+ *               [--backends shell,pinctrl,pinctrl-coproc,sysfs,gpiod,mmap]
+ *               [--priority 97] [--cpu -1] [--ticks-per-period 1]
+ *               [--wait block|spin|self] [--format csv|json]
+ *
+ * Each backend is driven by one periodic service at each rate. Exec time,
+ * release jitter and deadline misses come straight from RTStatistics and are
+ * printed as one row per (backend, rate) on stdout; progress goes to stderr.
+ *
+ * Hardware that is absent is replaced by a stand-in with the same syscall
+ * pattern (files on tmpfs instead of sysfs / gpiomem, ':' instead of the
+ * pinctrl binary), and such rows are flagged simulated=1.
+ */
+
+#include "Sequencer.hpp"
+#include "Pinctrl.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_GPIOD
+#include <gpiod.h>
+#endif
+
+// GPIO 23 everywhere, as in Methods 1-4
+#define BENCH_PIN 23
+#define GPIO_BLOCK_SIZE (4 * 1024)
+
+// Stand-ins live here (tmpfs), removed at exit
+static std::string standInDir;
+
+static bool fileWritable(const char* path)
+{
+    return access(path, W_OK) == 0;
+}
+
+// Create a zero-filled stand-in file of `size` bytes and return its path
+static std::string makeStandIn(const char* name, size_t size)
+{
+    std::string path = standInDir + "/" + name;
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd >= 0)
+    {
+        if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+        {
+            perror("ftruncate");
+        }
+        close(fd);
+    }
+    return path;
+}
+
+////////////////////////////////////////////
+// Backends
+////////////////////////////////////////////
+class GpioBackend
+{
+public:
+    virtual ~GpioBackend() = default;
+    virtual const char* name() const = 0;
+    virtual bool setup() = 0;
+    virtual void toggle() = 0;
+    virtual void cleanup() {}
+
+    bool simulated{false};
+};
+
+// Method 1 as it was: a shell and a pinctrl process per toggle
+class ShellBackend : public GpioBackend
+{
+public:
+    const char* name() const override { return "shell"; }
+
+    bool setup() override
+    {
+        simulated = std::system("command -v pinctrl >/dev/null 2>&1") != 0;
+        const char* tool = simulated ? ":" : "pinctrl";
+        snprintf(cmdHigh, sizeof(cmdHigh), "%s set %d op dh", tool, BENCH_PIN);
+        snprintf(cmdLow, sizeof(cmdLow), "%s set %d op dl", tool, BENCH_PIN);
+        return true;
+    }
+
+    void toggle() override
+    {
+        if (std::system(state ? cmdHigh : cmdLow) < 0)
+        {
+            perror("system");
+        }
+        state = !state;
+    }
+
+private:
+    char cmdHigh[64];
+    char cmdLow[64];
+    bool state{false};
+};
+
+// Method 1 with the in-process pinctrl (native registers or coprocess)
+class PinctrlBackend : public GpioBackend
+{
+public:
+    explicit PinctrlBackend(Pinctrl::Mode mode) : mode(mode) {}
+
+    const char* name() const override
+    {
+        return mode == Pinctrl::Mode::Native ? "pinctrl" : "pinctrl-coproc";
+    }
+
+    bool setup() override
+    {
+        if (mode == Pinctrl::Mode::Native)
+        {
+            simulated = !fileWritable("/dev/gpiomem");
+            std::string dev = simulated ? makeStandIn("gpiomem", GPIO_BLOCK_SIZE) : "/dev/gpiomem";
+            pinctrl = std::make_unique<Pinctrl>(mode, dev);
+        }
+        else
+        {
+            simulated = std::system("command -v pinctrl >/dev/null 2>&1") != 0;
+            pinctrl = std::make_unique<Pinctrl>(mode, "",
+                simulated ? "while read -r line; do :; done" : Pinctrl::defaultCoprocessCmd);
+        }
+
+        char text[32];
+        snprintf(text, sizeof(text), "set %d op dh", BENCH_PIN);
+        parsePinctrlCommand(text, high);
+        snprintf(text, sizeof(text), "set %d op dl", BENCH_PIN);
+        parsePinctrlCommand(text, low);
+        return pinctrl->init();
+    }
+
+    void toggle() override
+    {
+        pinctrl->run(state ? high : low);
+        state = !state;
+    }
+
+    void cleanup() override { pinctrl.reset(); }
+
+private:
+    Pinctrl::Mode mode;
+    std::unique_ptr<Pinctrl> pinctrl;
+    PinctrlCommand high;
+    PinctrlCommand low;
+    bool state{false};
+};
+
+// Method 2: open/write/close of the sysfs value file per toggle
+class SysfsBackend : public GpioBackend
+{
+public:
+    const char* name() const override { return "sysfs"; }
+
+    bool setup() override
+    {
+        valuePath = "/sys/class/gpio/gpio535/value";
+        simulated = !fileWritable(valuePath.c_str());
+        if (simulated) valuePath = makeStandIn("value", 1);
+        return true;
+    }
+
+    void toggle() override
+    {
+        int fd = open(valuePath.c_str(), O_WRONLY);
+        if (fd == -1) return;
+        if (write(fd, state ? "1" : "0", 1) != 1)
+        {
+            perror("Value write failed");
+        }
+        close(fd);
+        state = !state;
+    }
+
+private:
+    std::string valuePath;
+    bool state{false};
+};
+
+// Method 3: libgpiod line handle; without libgpiod, one write() on a held fd
+class GpiodBackend : public GpioBackend
+{
+public:
+    const char* name() const override { return "gpiod"; }
+
+#ifdef HAVE_GPIOD
+    bool setup() override
+    {
+        chip = gpiod_chip_open_by_name("gpiochip0");
+        if (!chip) return false;
+        line = gpiod_chip_get_line(chip, BENCH_PIN);
+        if (!line || gpiod_line_request_output(line, "gpio_bench", 0) < 0)
+        {
+            gpiod_chip_close(chip);
+            chip = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void toggle() override
+    {
+        gpiod_line_set_value(line, state ? 1 : 0);
+        state = !state;
+    }
+
+    void cleanup() override
+    {
+        if (!chip) return;
+        gpiod_line_release(line);
+        gpiod_chip_close(chip);
+        chip = nullptr;
+    }
+
+private:
+    gpiod_chip* chip{nullptr};
+    gpiod_line* line{nullptr};
+#else
+    bool setup() override
+    {
+        simulated = true;
+        fd = open(makeStandIn("gpiod-line", 1).c_str(), O_WRONLY);
+        return fd >= 0;
+    }
+
+    void toggle() override
+    {
+        if (pwrite(fd, state ? "1" : "0", 1, 0) != 1)
+        {
+            perror("pwrite");
+        }
+        state = !state;
+    }
+
+    void cleanup() override
+    {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+private:
+    int fd{-1};
+#endif
+    bool state{false};
+};
+
+// Method 4: register writes through a mapping. Uses /dev/gpiomem rather than
+// /dev/mem so a non-Pi host can never scribble over physical memory.
+class MmapBackend : public GpioBackend
+{
+public:
+    const char* name() const override { return "mmap"; }
+
+    bool setup() override
+    {
+        simulated = !fileWritable("/dev/gpiomem");
+        std::string dev = simulated ? makeStandIn("gpiomem-mmap", GPIO_BLOCK_SIZE) : "/dev/gpiomem";
+
+        int fd = open(dev.c_str(), O_RDWR | O_SYNC);
+        if (fd < 0) return false;
+        void* map = mmap(nullptr, GPIO_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) return false;
+        gpio = reinterpret_cast<volatile uint32_t*>(map);
+
+        // GPFSEL2, pin 23 -> output
+        int shift = (BENCH_PIN % 10) * 3;
+        gpio[BENCH_PIN / 10] = (gpio[BENCH_PIN / 10] & ~(0b111u << shift)) | (0b001u << shift);
+        return true;
+    }
+
+    void toggle() override
+    {
+        gpio[state ? 7 : 10] = (1u << BENCH_PIN);  // GPSET0 / GPCLR0
+        state = !state;
+    }
+
+    void cleanup() override
+    {
+        if (gpio) munmap((void*)gpio, GPIO_BLOCK_SIZE);
+        gpio = nullptr;
+    }
+
+private:
+    volatile uint32_t* gpio{nullptr};
+    bool state{false};
+};
+
+static std::unique_ptr<GpioBackend> makeBackend(const std::string& name)
+{
+    if (name == "shell") return std::make_unique<ShellBackend>();
+    if (name == "pinctrl") return std::make_unique<PinctrlBackend>(Pinctrl::Mode::Native);
+    if (name == "pinctrl-coproc") return std::make_unique<PinctrlBackend>(Pinctrl::Mode::Coprocess);
+    if (name == "sysfs") return std::make_unique<SysfsBackend>();
+    if (name == "gpiod") return std::make_unique<GpiodBackend>();
+    if (name == "mmap") return std::make_unique<MmapBackend>();
+    return nullptr;
+}
+
+////////////////////////////////////////////
+// Harness
+////////////////////////////////////////////
+struct BenchConfig
+{
+    std::vector<int> ratesHz{10, 100, 1000, 10000};
+    std::vector<std::string> backends{"shell", "pinctrl", "pinctrl-coproc", "sysfs", "gpiod", "mmap"};
+    int durationMs{2000};
+    int priority{97};
+    int cpuAffinity{-1};
+    int ticksPerPeriod{1};
+    WaitStrategy wait{WaitStrategy::Block};
+    bool json{false};
+};
+
+struct BenchRow
+{
+    std::string backend;
+    bool simulated;
+    int rateHz;
+    long long periodUs;
+    long long durationMs;   // measured, the main thread may oversleep under load
+    long long jobs;
+    long long releases;
+    double execMinUs, execAvgUs, execMaxUs, execJitterAvgUs;
+    double relJitterMinUs, relJitterAvgUs, relJitterMaxUs;
+    long long deadlineMisses;
+    long long minorFaults, majorFaults;
+};
+
+static std::vector<std::string> splitList(const char* text)
+{
+    std::vector<std::string> items;
+    std::string item;
+    for (const char* p = text; ; p++)
+    {
+        if (*p == ',' || *p == '\0')
+        {
+            if (!item.empty()) items.push_back(item);
+            item.clear();
+            if (*p == '\0') break;
+        }
+        else
+        {
+            item += *p;
+        }
+    }
+    return items;
+}
+
+static bool parseArgs(int argc, char* argv[], BenchConfig& cfg)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool takesValue = strcmp(arg, "--rates") == 0 || strcmp(arg, "--backends") == 0
+                       || strcmp(arg, "--duration-ms") == 0 || strcmp(arg, "--priority") == 0
+                       || strcmp(arg, "--cpu") == 0 || strcmp(arg, "--ticks-per-period") == 0
+                       || strcmp(arg, "--format") == 0 || strcmp(arg, "--wait") == 0;
+        if (takesValue && !val)
+        {
+            std::cerr << arg << " needs a value\n";
+            return false;
+        }
+
+        if (strcmp(arg, "--rates") == 0)
+        {
+            cfg.ratesHz.clear();
+            for (auto &r : splitList(val)) cfg.ratesHz.push_back(std::atoi(r.c_str()));
+        }
+        else if (strcmp(arg, "--backends") == 0)       cfg.backends = splitList(val);
+        else if (strcmp(arg, "--duration-ms") == 0)    cfg.durationMs = std::atoi(val);
+        else if (strcmp(arg, "--priority") == 0)       cfg.priority = std::atoi(val);
+        else if (strcmp(arg, "--cpu") == 0)            cfg.cpuAffinity = std::atoi(val);
+        else if (strcmp(arg, "--ticks-per-period") == 0) cfg.ticksPerPeriod = std::atoi(val);
+        else if (strcmp(arg, "--format") == 0)         cfg.json = strcmp(val, "json") == 0;
+        else if (strcmp(arg, "--wait") == 0)
+        {
+            cfg.wait = strcmp(val, "spin") == 0 ? WaitStrategy::SpinThenBlock
+                     : strcmp(val, "self") == 0 ? WaitStrategy::SelfTimed
+                     : WaitStrategy::Block;
+        }
+        else
+        {
+            std::cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+        i++;
+    }
+
+    for (int rate : cfg.ratesHz)
+    {
+        if (rate < 1 || rate > 100000)
+        {
+            std::cerr << "rate " << rate << " Hz out of range\n";
+            return false;
+        }
+    }
+    if (cfg.ticksPerPeriod < 1 || cfg.durationMs < 1)
+    {
+        std::cerr << "bad --ticks-per-period / --duration-ms\n";
+        return false;
+    }
+    return true;
+}
+
+// False (nothing to report) if the Sequencer did not start
+static bool runOne(GpioBackend& backend, int rateHz, const BenchConfig& cfg, BenchRow& row)
+{
+    auto period = std::chrono::microseconds(1000000 / rateHz);
+    auto tick = std::max(std::chrono::microseconds(1), period / cfg.ticksPerPeriod);
+
+    Sequencer seq;
+    seq.addService(backend.name(), [&backend] { backend.toggle(); },
+                   cfg.priority, cfg.cpuAffinity, period);
+    seq.setWaitStrategy(backend.name(), cfg.wait);
+    auto begin = std::chrono::steady_clock::now();
+    if (!seq.startServices(tick)) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(cfg.durationMs));
+    seq.stopServices();
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    const RTStatistics& st = *seq.getStatistics(backend.name());
+    long long jobs = st.count.load();
+
+    row = BenchRow{};
+    row.backend = backend.name();
+    row.simulated = backend.simulated;
+    row.rateHz = rateHz;
+    row.periodUs = period.count();
+    row.durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    row.jobs = jobs;
+    row.releases = st.releaseCount.load();
+    row.execMinUs = jobs ? st.minExecNs.load() / 1e3 : 0.0;
+    row.execAvgUs = st.avgExecNs() / 1e3;
+    row.execMaxUs = st.maxExecNs.load() / 1e3;
+    row.execJitterAvgUs = st.avgExecJitterNs() / 1e3;
+    row.relJitterMinUs = row.releases ? st.minReleaseJitterNs.load() / 1e3 : 0.0;
+    row.relJitterAvgUs = st.avgReleaseJitterNs() / 1e3;
+    row.relJitterMaxUs = st.maxReleaseJitterNs.load() / 1e3;
+    row.deadlineMisses = st.deadlineMissCount.load();
+    row.minorFaults = st.minorFaults.load();
+    row.majorFaults = st.majorFaults.load();
+    return true;
+}
+
+static void printRows(const std::vector<BenchRow>& rows, bool json)
+{
+    if (json)
+    {
+        printf("[\n");
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            const BenchRow& r = rows[i];
+            printf("  {\"backend\": \"%s\", \"simulated\": %s, \"rate_hz\": %d, \"period_us\": %lld, \"duration_ms\": %lld, "
+                   "\"jobs\": %lld, \"releases\": %lld, "
+                   "\"exec_min_us\": %.3f, \"exec_avg_us\": %.3f, \"exec_max_us\": %.3f, "
+                   "\"exec_jitter_avg_us\": %.3f, "
+                   "\"rel_jitter_min_us\": %.3f, \"rel_jitter_avg_us\": %.3f, \"rel_jitter_max_us\": %.3f, "
+                   "\"deadline_misses\": %lld, \"minor_faults\": %lld, \"major_faults\": %lld}%s\n",
+                   r.backend.c_str(), r.simulated ? "true" : "false", r.rateHz, r.periodUs,
+                   r.durationMs, r.jobs, r.releases, r.execMinUs, r.execAvgUs, r.execMaxUs, r.execJitterAvgUs,
+                   r.relJitterMinUs, r.relJitterAvgUs, r.relJitterMaxUs, r.deadlineMisses,
+                   r.minorFaults, r.majorFaults, i + 1 < rows.size() ? "," : "");
+        }
+        printf("]\n");
+        return;
+    }
+
+    printf("backend,simulated,rate_hz,period_us,duration_ms,jobs,releases,"
+           "exec_min_us,exec_avg_us,exec_max_us,exec_jitter_avg_us,"
+           "rel_jitter_min_us,rel_jitter_avg_us,rel_jitter_max_us,deadline_misses,"
+           "minor_faults,major_faults\n");
+    for (const BenchRow& r : rows)
+    {
+        printf("%s,%d,%d,%lld,%lld,%lld,%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%lld,%lld,%lld\n",
+               r.backend.c_str(), r.simulated ? 1 : 0, r.rateHz, r.periodUs, r.durationMs, r.jobs, r.releases,
+               r.execMinUs, r.execAvgUs, r.execMaxUs, r.execJitterAvgUs,
+               r.relJitterMinUs, r.relJitterAvgUs, r.relJitterMaxUs, r.deadlineMisses,
+               r.minorFaults, r.majorFaults);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) return 2;
+
+    char dirTemplate[] = "/dev/shm/gpiobench.XXXXXX";
+    if (!mkdtemp(dirTemplate))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    standInDir = dirTemplate;
+
+    std::vector<BenchRow> rows;
+    for (auto &name : cfg.backends)
+    {
+        auto backend = makeBackend(name);
+        if (!backend)
+        {
+            std::cerr << "unknown backend " << name << "\n";
+            continue;
+        }
+        if (!backend->setup())
+        {
+            std::cerr << name << ": setup failed, skipped\n";
+            continue;
+        }
+
+        for (int rate : cfg.ratesHz)
+        {
+            std::cerr << "running " << name << (backend->simulated ? " (simulated)" : "")
+                      << " @ " << rate << " Hz\n";
+            BenchRow row;
+            if (runOne(*backend, rate, cfg, row)) rows.push_back(row);
+            else std::cerr << name << " @ " << rate << " Hz: Sequencer did not start, skipped\n";
+        }
+        backend->cleanup();
+    }
+
+    printRows(rows, cfg.json);
+
+    std::string rm = "rm -rf " + standInDir;
+    if (std::system(rm.c_str()) != 0)
+    {
+        std::cerr << "could not remove " << standInDir << "\n";
+    }
+    return 0;
+}
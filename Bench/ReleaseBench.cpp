@@ -0,0 +1,446 @@
+/*
+ * Release path microbenchmarks
+ *
+ *   ./ReleaseBench [--releases 2000] [--period-us 1000] [--priority 97]
+ *                  [--cpu -1] [--waker-cpu -1] [--spin-us 20] [--format text|csv]
+ *
+ * Part 1 ("sequencer/..."): one no-op service under the real Sequencer with a
+ * stage probe installed, split into the hops of the release chain:
+ *
+ *   timer expiry -> alarmHandler -> onAlarm -> releaseSem.release()
+ *                -> worker acquire() returns -> serviceFunc start
+ *
+ * Part 2 ("handoff/..."): the release -> wake hop alone, for alternative
+ * wakeup primitives. A waker thread sleeps to absolute release times
+ * (clock_nanosleep) and signals, the waiter timestamps its wakeup.
+ *
+ * Every stage is printed as a log2 histogram with exact percentiles.
+ */
+
+#include "Sequencer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+struct BenchConfig
+{
+    int releases{2000};
+    int periodUs{1000};
+    int priority{97};
+    int cpuAffinity{-1};
+    int wakerCpu{-1};
+    int spinUs{20};
+    bool csv{false};
+};
+
+static long long nowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void configureThread(int priority, int cpu)
+{
+    if (cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (priority > 0)
+    {
+        sched_param sp{};
+        sp.sched_priority = priority;
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    }
+}
+
+////////////////////////////////////////////
+// Histogram
+////////////////////////////////////////////
+class LatencyHistogram
+{
+public:
+    LatencyHistogram(std::string name, size_t capacity) : name(std::move(name))
+    {
+        samples.reserve(capacity);
+    }
+
+    // Preallocated: no allocation while samples fit
+    void add(long long ns)
+    {
+        if (samples.size() < samples.capacity()) samples.push_back(ns < 0 ? 0 : ns);
+    }
+
+    size_t size() const { return samples.size(); }
+
+    void print(bool csv)
+    {
+        if (samples.empty())
+        {
+            if (!csv) printf("%-36s (no samples)\n", name.c_str());
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        // log2 buckets: [2^b, 2^(b+1)) ns
+        long long buckets[64] = {};
+        for (long long v : samples)
+        {
+            int b = v > 0 ? 63 - __builtin_clzll(static_cast<unsigned long long>(v)) : 0;
+            buckets[b]++;
+        }
+
+        if (csv)
+        {
+            for (int b = 0; b < 64; b++)
+            {
+                if (buckets[b] == 0) continue;
+                printf("%s,%lld,%lld,%lld\n", name.c_str(), 1LL << b, 1LL << (b + 1), buckets[b]);
+            }
+            return;
+        }
+
+        printf("%-36s n=%zu min=%.2f p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f max=%.2f us\n",
+               name.c_str(), samples.size(), samples.front() / 1e3, percentile(0.50) / 1e3,
+               percentile(0.90) / 1e3, percentile(0.99) / 1e3, percentile(0.999) / 1e3,
+               samples.back() / 1e3);
+
+        long long peak = *std::max_element(buckets, buckets + 64);
+        for (int b = 0; b < 64; b++)
+        {
+            if (buckets[b] == 0) continue;
+            int bar = static_cast<int>(40 * buckets[b] / peak);
+            printf("    [%9.2f, %9.2f) us %8lld |%.*s\n", (1LL << b) / 1e3, (1LL << (b + 1)) / 1e3,
+                   buckets[b], bar > 0 ? bar : 1, "########################################");
+        }
+    }
+
+private:
+    std::string name;
+    std::vector<long long> samples;
+
+    long long percentile(double p) const
+    {
+        size_t idx = static_cast<size_t>(p * double(samples.size() - 1));
+        return samples[idx];
+    }
+};
+
+////////////////////////////////////////////
+// Part 1: the Sequencer release chain
+////////////////////////////////////////////
+static void benchSequencer(const BenchConfig& cfg)
+{
+    size_t n = static_cast<size_t>(cfg.releases);
+    LatencyHistogram expiryToHandler("sequencer/expiry->handler", n);
+    LatencyHistogram handlerToOnAlarm("sequencer/handler->onAlarm", n);
+    LatencyHistogram onAlarmToRelease("sequencer/onAlarm->release", n);
+    LatencyHistogram releaseToWake("sequencer/release->wake", n);
+    LatencyHistogram wakeToStart("sequencer/wake->start", n);
+    LatencyHistogram total("sequencer/expiry->start", n);
+    std::atomic<size_t> collected{0};
+
+    Sequencer seq;
+    seq.addService("probe", [] {}, cfg.priority, cfg.cpuAffinity,
+                   std::chrono::microseconds(cfg.periodUs));
+    seq.setStageProbe([&](const Service&, const ReleaseStages& s) {
+        if (collected.load() >= n) return;
+        expiryToHandler.add(s.handlerNs - s.timerExpiryNs);
+        handlerToOnAlarm.add(s.onAlarmNs - s.handlerNs);
+        onAlarmToRelease.add(s.releaseNs - s.onAlarmNs);
+        releaseToWake.add(s.wakeNs - s.releaseNs);
+        wakeToStart.add(s.startNs - s.wakeNs);
+        total.add(s.startNs - s.timerExpiryNs);
+        collected++;
+    });
+
+    if (!seq.startServices(std::chrono::microseconds(cfg.periodUs)))
+    {
+        std::cerr << "sequencer: Sequencer did not start\n";
+        return;
+    }
+    auto timeout = std::chrono::steady_clock::now()
+                 + std::chrono::microseconds(static_cast<long long>(cfg.periodUs) * cfg.releases * 4)
+                 + std::chrono::seconds(2);
+    while (collected.load() < n && std::chrono::steady_clock::now() < timeout)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    seq.stopServices();
+
+    expiryToHandler.print(cfg.csv);
+    handlerToOnAlarm.print(cfg.csv);
+    onAlarmToRelease.print(cfg.csv);
+    releaseToWake.print(cfg.csv);
+    wakeToStart.print(cfg.csv);
+    total.print(cfg.csv);
+}
+
+////////////////////////////////////////////
+// Part 2: wakeup primitives
+////////////////////////////////////////////
+class Handoff
+{
+public:
+    virtual ~Handoff() = default;
+    virtual const char* name() const = 0;
+    virtual void signal() = 0;
+    virtual void wait() = 0;
+};
+
+static long futexCall(std::atomic<int>* word, int op, int val)
+{
+    return syscall(SYS_futex, reinterpret_cast<int*>(word), op, val, nullptr, nullptr, 0);
+}
+
+// What the Sequencer uses today
+class SemaphoreHandoff : public Handoff
+{
+public:
+    const char* name() const override { return "handoff/counting_semaphore"; }
+    void signal() override { sem.release(); }
+    void wait() override { sem.acquire(); }
+
+private:
+    std::counting_semaphore<1> sem{0};
+};
+
+// Raw futex on a flag word
+class FutexHandoff : public Handoff
+{
+public:
+    const char* name() const override { return "handoff/futex"; }
+
+    void signal() override
+    {
+        word.store(1, std::memory_order_release);
+        futexCall(&word, FUTEX_WAKE_PRIVATE, 1);
+    }
+
+    void wait() override
+    {
+        while (word.exchange(0, std::memory_order_acquire) == 0)
+        {
+            futexCall(&word, FUTEX_WAIT_PRIVATE, 0);
+        }
+    }
+
+private:
+    std::atomic<int> word{0};
+};
+
+class EventfdHandoff : public Handoff
+{
+public:
+    EventfdHandoff() : fd(eventfd(0, EFD_CLOEXEC)) {}
+    ~EventfdHandoff() override { close(fd); }
+    const char* name() const override { return "handoff/eventfd"; }
+
+    void signal() override
+    {
+        uint64_t one = 1;
+        if (write(fd, &one, sizeof(one)) != sizeof(one)) perror("eventfd write");
+    }
+
+    void wait() override
+    {
+        uint64_t value;
+        if (read(fd, &value, sizeof(value)) != sizeof(value)) perror("eventfd read");
+    }
+
+private:
+    int fd;
+};
+
+class CondvarHandoff : public Handoff
+{
+public:
+    const char* name() const override { return "handoff/condition_variable"; }
+
+    void signal() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ready = true;
+        }
+        cv.notify_one();
+    }
+
+    void wait() override
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return ready; });
+        ready = false;
+    }
+
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool ready{false};
+};
+
+// Spin on the flag for a while, then park on a futex. The waker only pays
+// for FUTEX_WAKE when the waiter actually parked.
+class SpinParkHandoff : public Handoff
+{
+public:
+    explicit SpinParkHandoff(long long spinNs) : spinNs(spinNs) {}
+    const char* name() const override { return "handoff/spin_then_park"; }
+
+    void signal() override
+    {
+        if (state.exchange(SIGNALED, std::memory_order_release) == PARKED)
+        {
+            futexCall(&state, FUTEX_WAKE_PRIVATE, 1);
+        }
+    }
+
+    void wait() override
+    {
+        long long until = nowNs() + spinNs;
+        while (state.load(std::memory_order_acquire) != SIGNALED && nowNs() < until)
+        {
+            cpuRelax();
+        }
+
+        int expected = IDLE;
+        if (state.compare_exchange_strong(expected, PARKED))
+        {
+            while (state.load(std::memory_order_acquire) == PARKED)
+            {
+                futexCall(&state, FUTEX_WAIT_PRIVATE, PARKED);
+            }
+        }
+        state.store(IDLE, std::memory_order_relaxed);
+    }
+
+private:
+    enum { IDLE = 0, SIGNALED = 1, PARKED = 2 };
+    std::atomic<int> state{IDLE};
+    long long spinNs;
+};
+
+static void benchHandoff(Handoff& handoff, const BenchConfig& cfg)
+{
+    size_t n = static_cast<size_t>(cfg.releases);
+    LatencyHistogram sleepLate(std::string(handoff.name()) + " sleep", n);
+    LatencyHistogram wakeLatency(std::string(handoff.name()), n);
+    std::atomic<long long> signalNs{0};
+    std::atomic<bool> done{false};
+
+    std::thread waiter([&] {
+        configureThread(cfg.priority, cfg.cpuAffinity);
+        while (true)
+        {
+            handoff.wait();
+            long long woke = nowNs();
+            if (done.load()) break;
+            wakeLatency.add(woke - signalNs.load());
+        }
+    });
+
+    std::thread waker([&] {
+        configureThread(cfg.priority, cfg.wakerCpu);
+        timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        for (int i = 0; i < cfg.releases; i++)
+        {
+            next.tv_nsec += cfg.periodUs * 1000L;
+            while (next.tv_nsec >= 1000000000L)
+            {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+
+            long long t0 = nowNs();
+            sleepLate.add(t0 - (next.tv_sec * 1000000000LL + next.tv_nsec));
+            signalNs.store(t0);
+            handoff.signal();
+        }
+        done.store(true);
+        handoff.signal();
+    });
+
+    waker.join();
+    waiter.join();
+
+    sleepLate.print(cfg.csv);
+    wakeLatency.print(cfg.csv);
+}
+
+static bool parseArgs(int argc, char* argv[], BenchConfig& cfg)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const char* val = argv[++i];
+
+        if (strcmp(arg, "--releases") == 0)        cfg.releases = std::atoi(val);
+        else if (strcmp(arg, "--period-us") == 0)  cfg.periodUs = std::atoi(val);
+        else if (strcmp(arg, "--priority") == 0)   cfg.priority = std::atoi(val);
+        else if (strcmp(arg, "--cpu") == 0)        cfg.cpuAffinity = std::atoi(val);
+        else if (strcmp(arg, "--waker-cpu") == 0)  cfg.wakerCpu = std::atoi(val);
+        else if (strcmp(arg, "--spin-us") == 0)    cfg.spinUs = std::atoi(val);
+        else if (strcmp(arg, "--format") == 0)     cfg.csv = strcmp(val, "csv") == 0;
+        else
+        {
+            std::cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (cfg.releases < 1 || cfg.periodUs < 10)
+    {
+        std::cerr << "need --releases >= 1 and --period-us >= 10\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig cfg;
+    if (!parseArgs(argc, argv, cfg)) return 2;
+
+    if (cfg.csv) printf("stage,bucket_lo_ns,bucket_hi_ns,count\n");
+
+    benchSequencer(cfg);
+
+    SemaphoreHandoff semaphore;
+    FutexHandoff futex;
+    EventfdHandoff efd;
+    CondvarHandoff condvar;
+    SpinParkHandoff spinPark(cfg.spinUs * 1000LL);
+    Handoff* handoffs[] = {&semaphore, &futex, &efd, &condvar, &spinPark};
+    for (Handoff* h : handoffs)
+    {
+        benchHandoff(*h, cfg);
+    }
+    return 0;
+}
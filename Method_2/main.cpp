@@ -4,6 +4,7 @@
  */
 
  #include "Sequencer.hpp"
+ #include "ServiceConfig.hpp"
  #include <csignal>
  #include <chrono>
  #include <thread>
@@ -24,6 +25,9 @@
  
  // GPIO number for pin 23
  const char* GPIO_NUM = "535";
+
+ // Built once in setupGpio(), so the RT toggle never allocates
+ std::string valPath;
  
  int setupGpio() {
      // Open export file
@@ -63,6 +67,8 @@
      }
      close(fd);
  
+     valPath = "/sys/class/gpio/gpio" + std::string(GPIO_NUM) + "/value";
+
      std::cout << "GPIO " << GPIO_NUM << " ready" << std::endl;
      return 0;
  }
@@ -91,7 +97,6 @@
      static int state = 0;
      
      // Open the value file which directly controls the GPIO state
-     std::string valPath = "/sys/class/gpio/gpio" + std::string(GPIO_NUM) + "/value";
      int fd = open(valPath.c_str(), O_WRONLY);
      if (fd == -1) {
          perror("Value open failed");
@@ -109,7 +114,16 @@
      state = !state;
  }
  
- int main() {
+ int main(int argc, char* argv[]) {
+     // Optional service config file (see ServiceConfig.hpp)
+     const char* configPath = nullptr;
+     if (argc == 3 && strcmp(argv[1], "--config") == 0) {
+         configPath = argv[2];
+     } else if (argc != 1) {
+         std::cerr << "usage: " << argv[0] << " [--config FILE]" << std::endl;
+         return 1;
+     }
+
      // Setup signal handler
      std::signal(SIGINT, sigHandler);
      
@@ -124,9 +138,35 @@
      // Create sequencer
      Sequencer seq;
  
-     // Add toggle service (100ms period)
-     seq.addService("gpio23_toggle", toggleGpio, 97, 1, 100);
-     seq.startServices(10);  // 10ms master interval
+     // Ctrl+C ends in the Sequencer's own SIGINT handler: unexport there too
+     seq.setShutdownHook([] {
+         std::cout << "Cleaning up GPIO before exit...\n";
+         cleanGpio();
+     });
+
+     // Add toggle service (100ms period), or whatever the config file says
+     SequencerConfig config;
+     if (configPath) {
+         ServiceRegistry registry;
+         registry.add("gpio23_toggle", toggleGpio);
+         if (!SequencerConfig::load(configPath, config) || !config.apply(seq, registry)) {
+             cleanGpio();
+             return 1;
+         }
+     } else {
+         seq.addService("gpio23_toggle", toggleGpio, 97, 1, 100);
+         config.masterInterval = std::chrono::milliseconds(10);  // 10ms master interval
+     }
+     if (!seq.startServices(config.masterInterval)) {
+         cleanGpio();
+         return 1;
+     }
+
+     // Period changes in the config file apply while running
+     ConfigWatcher watcher(seq, configPath ? configPath : "", config);
+     if (configPath) {
+         watcher.start();
+     }
      
      // Main loop
      std::cout << "Press Ctrl+C to exit" << std::endl;
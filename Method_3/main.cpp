@@ -4,6 +4,8 @@
  */
 
 #include "Sequencer.hpp"
+#include "ServiceConfig.hpp"
+#include <cstring>
 #include <csignal>
 #include <chrono>
 #include <thread>
@@ -117,8 +119,17 @@ void cleanGpio() {
     gpio.cleanup();
 }
 
-int main()
+int main(int argc, char* argv[])
  {
+    // Optional service config file (see ServiceConfig.hpp)
+    const char* configPath = nullptr;
+    if (argc == 3 && strcmp(argv[1], "--config") == 0) {
+        configPath = argv[2];
+    } else if (argc != 1) {
+        std::cerr << "usage: " << argv[0] << " [--config FILE]" << std::endl;
+        return 1;
+    }
+
     // Initialize GPIO
     if (!gpio.init()) {
         std::cerr << "GPIO setup failed" << std::endl;
@@ -130,11 +141,31 @@ int main()
     // Create sequencer
     Sequencer seq;
 
-    // Add toggle service with name, function, priority, CPU affinity, and period (ms)
-    seq.addService("gpio23_toggle", toggleGpio, 97, 1, 100);
+    // Add toggle service with name, function, priority, CPU affinity, and period (ms),
+    // or take them from the config file
+    SequencerConfig config;
+    if (configPath) {
+        ServiceRegistry registry;
+        registry.add("gpio23_toggle", toggleGpio);
+        if (!SequencerConfig::load(configPath, config) || !config.apply(seq, registry)) {
+            return 1;
+        }
+    } else {
+        seq.addService("gpio23_toggle", toggleGpio, 97, 1, 100);
+        config.masterInterval = std::chrono::milliseconds(10);
+    }
     
-    // Start sequencer with 10ms master interval
-    seq.startServices(10);
+    // Start sequencer with 10ms master interval (by default)
+    if (!seq.startServices(config.masterInterval)) {
+        cleanGpio();
+        return 1;
+    }
+
+    // Period changes in the config file apply while running
+    ConfigWatcher watcher(seq, configPath ? configPath : "", config);
+    if (configPath) {
+        watcher.start();
+    }
     
     // Main loop
     std::cout << "Toggling GPIO 23 every 100ms... Press Ctrl+C to exit" << std::endl;
@@ -7,6 +7,7 @@
  */
 
 #include "Sequencer.hpp"
+#include "ServiceConfig.hpp"
 #include <csignal>
 #include <chrono>
 #include <thread>
@@ -107,8 +108,16 @@ void cleanupGpio() {
     }
 }
 
-int main() {
-        
+int main(int argc, char* argv[]) {
+    // Optional service config file (see ServiceConfig.hpp)
+    const char* configPath = nullptr;
+    if (argc == 3 && strcmp(argv[1], "--config") == 0) {
+        configPath = argv[2];
+    } else if (argc != 1) {
+        std::cerr << "usage: " << argv[0] << " [--config FILE]" << std::endl;
+        return 1;
+    }
+
     std::cout << "Starting GPIO 23 toggle (Method 4: direct memory mapping)" << std::endl;
     
     // Set up memory-mapped GPIO
@@ -120,11 +129,31 @@ int main() {
     // Create sequencer
     Sequencer seq;
     
-    // Add toggle service (100ms period)
-    seq.addService("tglGpio",toggleGpio, 1, 97, 100);
+    // Add toggle service (100ms period), or take it from the config file
+    SequencerConfig config;
+    if (configPath) {
+        ServiceRegistry registry;
+        registry.add("tglGpio", toggleGpio);
+        if (!SequencerConfig::load(configPath, config) || !config.apply(seq, registry)) {
+            cleanupGpio();
+            return 1;
+        }
+    } else {
+        seq.addService("tglGpio",toggleGpio, 1, 97, 100);
+        config.masterInterval = std::chrono::milliseconds(10);
+    }
     
     // Start sequencer
-    seq.startServices(10);
+    if (!seq.startServices(config.masterInterval)) {
+        cleanupGpio();
+        return 1;
+    }
+
+    // Period changes in the config file apply while running
+    ConfigWatcher watcher(seq, configPath ? configPath : "", config);
+    if (configPath) {
+        watcher.start();
+    }
     
     std::cout << "Toggling GPIO 23 every 100ms... Press Ctrl+C to exit" << std::endl;
     
@@ -1,39 +1,170 @@
 #include "Sequencer.hpp"
+#include "Pinctrl.hpp"
+#include "StatsServer.hpp"
+#include "ServiceConfig.hpp"
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <cstdlib>
+#include <cstring>
 
-// Method 1: Toggle GPIO using shell command with pinctrl
-void toggleGpio23ShellCmd()
+// In-process pinctrl. Native by default; `--coprocess` keeps the real pinctrl
+// tool in the loop through one persistent shell fed over a pipe.
+static Pinctrl* pinctrl = nullptr;
+
+// Pre-parsed so the RT thread never touches a string
+static PinctrlCommand gpio23High;
+static PinctrlCommand gpio23Low;
+
+// Method 1: Toggle GPIO using the pinctrl command vocabulary
+void toggleGpio23Pinctrl()
 {
     static bool toggle = false;
     if (toggle) {
-        std::system("pinctrl set 23 op dh");  // Set GPIO 23 High
+        pinctrl->run(gpio23High);  // Set GPIO 23 High
     } else {
-        std::system("pinctrl set 23 op dl");  // Set GPIO 23 Low
+        pinctrl->run(gpio23Low);   // Set GPIO 23 Low
     }
     toggle = !toggle;
 }
 
-int main()
+// Must happen before the Sequencer starts any RT thread (coprocess spawns)
+static bool setupPinctrl(bool coprocess)
+{
+    static Pinctrl native(Pinctrl::Mode::Native);
+    static Pinctrl shell(Pinctrl::Mode::Coprocess);
+    if (!coprocess && native.init()) {
+        pinctrl = &native;
+    } else {
+        if (!coprocess) {
+            std::cerr << "Native pinctrl unavailable, falling back to coprocess\n";
+        }
+        if (!shell.init()) {
+            std::cerr << "pinctrl setup failed\n";
+            return false;
+        }
+        pinctrl = &shell;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
 {
-    std::cout << "Starting GPIO Toggling Demo with Method 1 (shell command)\n";
+    bool coprocess = false;
+    const char* statsSocket = nullptr;
+    bool telemetry = false;
+    const char* missLog = nullptr;
+    bool perf = false;
+    const char* configPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--coprocess") == 0) {
+            coprocess = true;
+        } else if (strcmp(argv[i], "--stats-socket") == 0 && i + 1 < argc) {
+            statsSocket = argv[++i];
+        } else if (strcmp(argv[i], "--telemetry") == 0) {
+            telemetry = true;
+        } else if (strcmp(argv[i], "--miss-log") == 0 && i + 1 < argc) {
+            missLog = argv[++i];
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            perf = true;
+        } else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            configPath = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--coprocess] [--stats-socket PATH] [--telemetry] [--miss-log PATH] [--perf]"
+                      << " [--config FILE]\n";
+            return 1;
+        }
+    }
+
+    if (!parsePinctrlCommand("pinctrl set 23 op dh", gpio23High) ||
+        !parsePinctrlCommand("pinctrl set 23 op dl", gpio23Low))
+    {
+        return 1;
+    }
 
     Sequencer seq;
 
-    // Add our GPIO toggle service with 100ms period
-    // Using priority 99 (high) and CPU affinity 0
-    seq.addService("gpio23Toggle", toggleGpio23ShellCmd, /*priority=*/99, /*cpuAffinity=*/0, /*periodMs=*/100);
+    // Ctrl+C: after the final statistics, whether GPIO edges were lost
+    seq.setShutdownHook([] {
+        if (pinctrl && pinctrl->dropped() > 0) {
+            std::cerr << "pinctrl: " << pinctrl->dropped() << " commands dropped\n";
+        }
+    });
+
+    // Services from a config file (see ServiceConfig.hpp): its backend
+    // ("native", "coprocess") picks the pinctrl mode
+    SequencerConfig config;
+    if (configPath) {
+        ServiceRegistry registry;
+        registry.addFactory("gpio23Toggle", [&](const ServiceConfig& svc) -> std::function<void()> {
+            if (!svc.backend.empty() && svc.backend != "native" && svc.backend != "coprocess") {
+                return nullptr;
+            }
+            if (!setupPinctrl(coprocess || svc.backend == "coprocess")) {
+                return nullptr;
+            }
+            return toggleGpio23Pinctrl;
+        });
+        if (!SequencerConfig::load(configPath, config) || !config.apply(seq, registry)) {
+            return 1;
+        }
+    } else {
+        if (!setupPinctrl(coprocess)) {
+            return 1;
+        }
+
+        // Add our GPIO toggle service with 100ms period
+        // Using priority 99 (high) and CPU affinity 0
+        seq.addService("gpio23Toggle", toggleGpio23Pinctrl, /*priority=*/99, /*cpuAffinity=*/0, /*periodMs=*/100);
+
+        // Master alarm ticks every 10 ms (provides good resolution for our 100ms service)
+        config.masterInterval = std::chrono::milliseconds(10);
+    }
+
+    if (pinctrl) {
+        std::cout << "Starting GPIO Toggling Demo with Method 1 (pinctrl, "
+                  << (pinctrl->mode() == Pinctrl::Mode::Native ? "in-process" : "coprocess") << ")\n";
+    }
+
+    // Rolling windows for the live stats (1 s, 1 min, 1 h)
+    seq.enableWindows({std::chrono::seconds(1), std::chrono::minutes(1), std::chrono::hours(1)});
+
+    // Shared-memory stats for Tools/SeqTelemetry
+    if (telemetry) {
+        seq.enableTelemetry();
+    }
+
+    // Forensic record of every deadline miss
+    if (missLog) {
+        seq.enableMissForensics(missLog);
+    }
 
-    // Master alarm ticks every 10 ms (provides good resolution for our 100ms service)
-    seq.startServices(/*masterIntervalMs=*/10);
+    // Cycles, instructions, cache misses, switches and faults per job
+    if (perf) {
+        seq.enablePerfCounters();
+    }
+
+    if (!seq.startServices(config.masterInterval)) {
+        return 1;
+    }
+
+    // Rate changes to the config file apply while running
+    ConfigWatcher watcher(seq, configPath ? configPath : "", config);
+    if (configPath && watcher.start()) {
+        std::cout << "Watching " << configPath << " for period changes\n";
+    }
+
+    // Live stats while running: echo json | nc -U <path>
+    StatsServer stats(seq, statsSocket ? statsSocket : "");
+    if (statsSocket && stats.start()) {
+        std::cout << "Serving statistics on " << statsSocket << "\n";
+    }
 
     // Main thread just waits for SIGINT (Ctrl+C)
     std::cout << "Press Ctrl+C to stop and view statistics...\n";
-    while(true) { 
-        std::this_thread::sleep_for(std::chrono::seconds(1)); 
+    while(true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
     }
-    
+
     return 0;
 }
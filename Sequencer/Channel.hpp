@@ -0,0 +1,332 @@
+#pragma once
+
+#include "Sequencer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+
+////////////////////////////////////////////
+// Inter-service channels
+////////////////////////////////////////////
+// Typed, preallocated message channels between services, so a pipeline
+// (sensor read -> filter -> actuate) needs neither shared globals nor a
+// mutex on an RT thread:
+//
+//   SpscChannel<T, N>   one producer, one consumer, N-slot ring. Wait-free.
+//   MpscChannel<T, N>   any number of producers, one consumer. The consumer
+//                       is wait-free; a producer retries only when another
+//                       producer claimed the same slot first (lock-free).
+//   LatestChannel<T>    latest value only (triple buffer). Wait-free; a new
+//                       value replaces one not yet read.
+//
+// The consumer reads at its release: receive() one message, or drain() all
+// of them. send() never blocks. A full queue drops the new message and
+// counts it. With setTrigger() a successful send() also releases a
+// triggered service (see ServiceTrigger), typically the consumer, so a
+// pipeline runs at the producer's rate with no polling.
+//
+// Every message carries its send time; the consumer records the send ->
+// receive latency in the channel's ChannelStats, which
+// Sequencer::watchChannel() prints with the final statistics. Both times
+// are taken on the clock of the job sending or receiving, so under a
+// VirtualClock latencies are virtual time; outside a job, steady_clock.
+// Under a VirtualClock, then, send and receive from jobs.
+//
+// T must be default constructible and copy assignable. Storage is inline:
+// for large T or N, give the channel static storage or allocate it once up
+// front.
+
+struct ChannelStats
+{
+    // Producer side
+    std::atomic<long long> sent{0};          // accepted by send()
+    std::atomic<long long> dropped{0};       // queue full / latest value overwritten unread
+
+    // Consumer side
+    alignas(CACHE_LINE_SIZE) std::atomic<long long> received{0};
+    std::atomic<long long> totalLatencyNs{0};
+    std::atomic<long long> maxLatencyNs{0};
+    RTHistogram latencyHist;                 // send -> receive
+
+    double avgLatencyNs() const
+    {
+        long long n = received.load(std::memory_order_relaxed);
+        return n > 0 ? double(totalLatencyNs.load(std::memory_order_relaxed)) / double(n) : 0.0;
+    }
+
+    // Consumer side only (single writer of these)
+    void recordReceive(long long latencyNs)
+    {
+        if (latencyNs < 0) latencyNs = 0;
+        received.fetch_add(1, std::memory_order_relaxed);
+        totalLatencyNs.fetch_add(latencyNs, std::memory_order_relaxed);
+        if (latencyNs > maxLatencyNs.load(std::memory_order_relaxed))
+        {
+            maxLatencyNs.store(latencyNs, std::memory_order_relaxed);
+        }
+        latencyHist.add(latencyNs);
+    }
+};
+
+// Send and receive times, on the calling job's clock
+inline long long channelNowNs()
+{
+    return Sequencer::jobNowNs(Sequencer::currentJob);
+}
+
+////////////////////////////////////////////
+// Single producer, single consumer
+////////////////////////////////////////////
+template <typename T, size_t N>
+class SpscChannel
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscChannel capacity must be a power of two");
+    static_assert(std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>,
+                  "SpscChannel messages must be default constructible and copy assignable");
+
+public:
+    ChannelStats stats;
+
+    // Release `trigger` after every accepted message
+    void setTrigger(ServiceTrigger trigger) { this->trigger = trigger; }
+
+    // Producer. False (and counted) if the channel is full.
+    bool send(const T& value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tailCache == N)
+        {
+            // Looks full: see how far the consumer really got
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h - tailCache == N)
+            {
+                stats.dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        Slot& slot = slots[h & (N - 1)];
+        slot.value = value;
+        slot.sentNs = channelNowNs();
+        head.store(h + 1, std::memory_order_release);
+        stats.sent.fetch_add(1, std::memory_order_relaxed);
+        if (trigger) trigger.release();
+        return true;
+    }
+
+    // Consumer. False if the channel is empty.
+    bool receive(T& out)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == headCache)
+        {
+            headCache = head.load(std::memory_order_acquire);
+            if (t == headCache) return false;
+        }
+        const Slot& slot = slots[t & (N - 1)];
+        out = slot.value;
+        stats.recordReceive(channelNowNs() - slot.sentNs);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: hand every message already sent to `f(const T&)`, oldest
+    // first. Returns how many. Bounded: what arrives meanwhile waits for the
+    // next drain().
+    template <typename F>
+    size_t drain(F&& f)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        headCache = head.load(std::memory_order_acquire);
+        size_t n = headCache - t;
+        long long now = channelNowNs();
+        for (size_t i = 0; i < n; i++)
+        {
+            const Slot& slot = slots[(t + i) & (N - 1)];
+            f(slot.value);
+            stats.recordReceive(now - slot.sentNs);
+        }
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    struct Slot
+    {
+        T value{};
+        long long sentNs{0};
+    };
+    Slot slots[N];
+    ServiceTrigger trigger;
+
+    // Producer's line: its position and its last view of the consumer's
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};
+    size_t tailCache{0};
+    // Consumer's line
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};
+    size_t headCache{0};
+};
+
+////////////////////////////////////////////
+// Multiple producers, single consumer
+////////////////////////////////////////////
+// Bounded ring with a sequence number per cell (as MissQueue)
+template <typename T, size_t N>
+class MpscChannel
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscChannel capacity must be a power of two");
+    static_assert(std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>,
+                  "MpscChannel messages must be default constructible and copy assignable");
+
+public:
+    ChannelStats stats;
+
+    MpscChannel()
+    {
+        for (size_t i = 0; i < N; i++) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    // Release `trigger` after every accepted message
+    void setTrigger(ServiceTrigger trigger) { this->trigger = trigger; }
+
+    // Any producer. False (and counted) if the channel is full.
+    bool send(const T& value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = cells[pos & (N - 1)];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            long long diff = static_cast<long long>(seq) - static_cast<long long>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sentNs = channelNowNs();
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    stats.sent.fetch_add(1, std::memory_order_relaxed);
+                    if (trigger) trigger.release();
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                stats.dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer. False if the channel is empty (or the oldest message is
+    // still being written).
+    bool receive(T& out)
+    {
+        // Single consumer: no CAS needed on dequeuePos
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & (N - 1)];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        if (static_cast<long long>(seq) - static_cast<long long>(pos + 1) < 0) return false;
+
+        out = cell.value;
+        stats.recordReceive(channelNowNs() - cell.sentNs);
+        cell.seq.store(pos + N, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer: hand every complete message to `f(const T&)`, oldest first,
+    // at most N per call. Returns how many.
+    template <typename F>
+    size_t drain(F&& f)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        long long now = channelNowNs();
+        size_t n = 0;
+        for (; n < N; n++, pos++)
+        {
+            Cell& cell = cells[pos & (N - 1)];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            if (static_cast<long long>(seq) - static_cast<long long>(pos + 1) < 0) break;
+            f(cell.value);
+            stats.recordReceive(now - cell.sentNs);
+            cell.seq.store(pos + N, std::memory_order_release);
+        }
+        dequeuePos.store(pos, std::memory_order_relaxed);
+        return n;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> seq;
+        T value{};
+        long long sentNs{0};
+    };
+    Cell cells[N];
+    ServiceTrigger trigger;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos{0};
+};
+
+////////////////////////////////////////////
+// Latest value
+////////////////////////////////////////////
+// Triple buffer: the producer writes its back buffer and swaps it with the
+// middle one, the consumer swaps its front buffer with the middle one when
+// that holds something new. Neither ever waits for the other.
+template <typename T>
+class LatestChannel
+{
+    static_assert(std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>,
+                  "LatestChannel values must be default constructible and copy assignable");
+
+public:
+    ChannelStats stats;
+
+    // Release `trigger` after every value
+    void setTrigger(ServiceTrigger trigger) { this->trigger = trigger; }
+
+    // Producer. Always succeeds; a value not read yet is replaced (counted
+    // as dropped).
+    void send(const T& value)
+    {
+        buffers[back].value = value;
+        buffers[back].sentNs = channelNowNs();
+        unsigned previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX;
+        if (previous & FRESH) stats.dropped.fetch_add(1, std::memory_order_relaxed);
+        stats.sent.fetch_add(1, std::memory_order_relaxed);
+        if (trigger) trigger.release();
+    }
+
+    // Consumer. True (and the value in `out`) if a value arrived since the
+    // last receive(); false leaves `out` alone.
+    bool receive(T& out)
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        out = buffers[front].value;
+        stats.recordReceive(channelNowNs() - buffers[front].sentNs);
+        return true;
+    }
+
+private:
+    static constexpr unsigned INDEX = 3;
+    static constexpr unsigned FRESH = 4;
+
+    struct alignas(CACHE_LINE_SIZE) Buffer
+    {
+        T value{};
+        long long sentNs{0};
+    };
+    Buffer buffers[3];
+    ServiceTrigger trigger;
+    alignas(CACHE_LINE_SIZE) unsigned back{0};       // producer's
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned> middle{1};
+    alignas(CACHE_LINE_SIZE) unsigned front{2};      // consumer's
+};
@@ -0,0 +1,299 @@
+#include "Coordinator.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static long long monotonicNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static long long toPpm(double utilization)
+{
+    return std::llround(utilization * 1e6);
+}
+
+ReleaseCoordinator::ReleaseCoordinator(std::string name, std::chrono::nanoseconds grid, double limit, mode_t mode)
+    : name(std::move(name)), requestedGrid(grid), requestedLimit(limit), mode(mode)
+{
+}
+
+ReleaseCoordinator::~ReleaseCoordinator()
+{
+    if (!header) return;
+    release();
+    munmap(header, sizeof(CoordHeader) + SEQ_COORD_SLOTS * sizeof(CoordSlot));
+}
+
+bool ReleaseCoordinator::open()
+{
+    if (header) return true;
+    if (requestedGrid.count() <= 0 || requestedLimit <= 0)
+    {
+        std::cerr << "coord: the grid and the limit must be positive\n";
+        return false;
+    }
+    // Whoever gets O_EXCL creates it; a creator that loses the race joins
+    if (create()) return true;
+    if (errno != EEXIST) return false;
+    return attach();
+}
+
+bool ReleaseCoordinator::create()
+{
+    size_t bytes = sizeof(CoordHeader) + SEQ_COORD_SLOTS * sizeof(CoordSlot);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+    if (fd < 0)
+    {
+        if (errno != EEXIST) std::cerr << "coord: shm_open " << name << " failed: " << strerror(errno) << "\n";
+        return false;
+    }
+    // The umask may have cleared bits the caller asked for
+    if (fchmod(fd, mode) < 0)
+    {
+        std::cerr << "coord: cannot set the mode of " << name << ": " << strerror(errno) << "\n";
+        close(fd);
+        shm_unlink(name.c_str());
+        errno = EIO;
+        return false;
+    }
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) == 0)
+    {
+        map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "coord: cannot set up " << name << ": " << strerror(errno) << "\n";
+        shm_unlink(name.c_str());
+        errno = EIO;
+        return false;
+    }
+
+    memset(map, 0, bytes);
+    header = static_cast<CoordHeader*>(map);
+    slots = reinterpret_cast<CoordSlot*>(static_cast<char*>(map) + sizeof(CoordHeader));
+    header->version = SEQ_COORD_VERSION;
+    header->headerSize = sizeof(CoordHeader);
+    header->slotSize = sizeof(CoordSlot);
+    header->slotCount = SEQ_COORD_SLOTS;
+    header->epochNs = monotonicNowNs();
+    header->gridNs = requestedGrid.count();
+    header->limitPpm = toPpm(requestedLimit);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    // Joiners wait for this
+    std::atomic_ref<uint32_t>(header->magic).store(SEQ_COORD_MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool ReleaseCoordinator::attach()
+{
+    size_t bytes = sizeof(CoordHeader) + SEQ_COORD_SLOTS * sizeof(CoordSlot);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        std::cerr << "coord: shm_open " << name << " failed: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    // The creator may still be sizing it
+    struct stat st{};
+    for (int i = 0; i < 1000 && fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < bytes; i++) usleep(1000);
+    if (static_cast<size_t>(st.st_size) != bytes)
+    {
+        std::cerr << "coord: " << name << " is not a version " << SEQ_COORD_VERSION << " coordination segment\n";
+        close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "coord: mmap failed: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    auto* h = static_cast<CoordHeader*>(map);
+    std::atomic_ref<uint32_t> magic(h->magic);
+    for (int i = 0; i < 1000 && magic.load(std::memory_order_acquire) != SEQ_COORD_MAGIC; i++) usleep(1000);
+    if (magic.load(std::memory_order_acquire) != SEQ_COORD_MAGIC || h->version != SEQ_COORD_VERSION
+        || h->headerSize != sizeof(CoordHeader) || h->slotSize != sizeof(CoordSlot) || h->slotCount != SEQ_COORD_SLOTS)
+    {
+        std::cerr << "coord: " << name << " is not a version " << SEQ_COORD_VERSION << " coordination segment\n";
+        munmap(map, bytes);
+        return false;
+    }
+    header = h;
+    slots = reinterpret_cast<CoordSlot*>(static_cast<char*>(map) + sizeof(CoordHeader));
+
+    if (header->gridNs != requestedGrid.count() || header->limitPpm != toPpm(requestedLimit))
+    {
+        std::cerr << "coord: " << name << " runs grid " << header->gridNs / 1e6 << " ms, limit "
+                  << header->limitPpm / 1e4 << "%; using those\n";
+    }
+    return true;
+}
+
+std::chrono::nanoseconds ReleaseCoordinator::grid() const
+{
+    return std::chrono::nanoseconds(header ? header->gridNs : requestedGrid.count());
+}
+
+double ReleaseCoordinator::limit() const
+{
+    return header ? double(header->limitPpm) / 1e6 : requestedLimit;
+}
+
+std::chrono::steady_clock::time_point ReleaseCoordinator::nextBoundary(std::chrono::nanoseconds lead) const
+{
+    long long earliest = monotonicNowNs() + lead.count();
+    if (!header) return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(earliest));
+
+    long long epoch = header->epochNs;
+    long long grid = header->gridNs;
+    long long k = earliest <= epoch ? 0 : (earliest - epoch + grid - 1) / grid;
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(epoch + k * grid));
+}
+
+bool ReleaseCoordinator::lock()
+{
+    int rc = pthread_mutex_lock(&header->lock);
+    if (rc == EOWNERDEAD)
+    {
+        // Its holder died mid-update: the slots are still whole records
+        pthread_mutex_consistent(&header->lock);
+        return true;
+    }
+    if (rc != 0)
+    {
+        std::cerr << "coord: lock failed: " << strerror(rc) << "\n";
+        return false;
+    }
+    return true;
+}
+
+void ReleaseCoordinator::unlock()
+{
+    pthread_mutex_unlock(&header->lock);
+}
+
+void ReleaseCoordinator::pruneDead()
+{
+    for (int i = 0; i < SEQ_COORD_SLOTS; i++)
+    {
+        if (slots[i].pid != 0 && kill(slots[i].pid, 0) < 0 && errno == ESRCH) slots[i] = CoordSlot{};
+    }
+}
+
+bool ReleaseCoordinator::reserve(const std::map<int, double>& demand)
+{
+    if (!header || !lock()) return false;
+    pruneDead();
+    pid_t self = getpid();
+
+    // Check everything first: all or nothing
+    int needed = 0, freeSlots = 0;
+    for (int i = 0; i < SEQ_COORD_SLOTS; i++)
+    {
+        if (slots[i].pid == 0) freeSlots++;
+        if (slots[i].pid == self) freeSlots++;  // replaced below
+    }
+    for (auto& [cpu, utilization] : demand)
+    {
+        long long ppm = toPpm(utilization);
+        if (ppm <= 0) continue;
+        needed++;
+        long long others = 0;
+        for (int i = 0; i < SEQ_COORD_SLOTS; i++)
+        {
+            if (slots[i].pid != 0 && slots[i].pid != self && slots[i].cpu == cpu) others += slots[i].ppm;
+        }
+        if (others + ppm > header->limitPpm)
+        {
+            std::cerr << "coord: CPU " << cpu << ": " << ppm / 1e4 << "% does not fit, limit "
+                      << header->limitPpm / 1e4 << "%, reserved:";
+            for (int i = 0; i < SEQ_COORD_SLOTS; i++)
+            {
+                if (slots[i].pid == 0 || slots[i].pid == self || slots[i].cpu != cpu) continue;
+                std::cerr << " " << slots[i].owner << "[" << slots[i].pid << "] " << slots[i].ppm / 1e4 << "%";
+            }
+            std::cerr << "\n";
+            unlock();
+            return false;
+        }
+    }
+    if (needed > freeSlots)
+    {
+        std::cerr << "coord: " << name << " is full (" << SEQ_COORD_SLOTS << " reservations)\n";
+        unlock();
+        return false;
+    }
+
+    char owner[SEQ_COORD_NAME] = {};
+    FILE* comm = fopen("/proc/self/comm", "r");
+    if (comm)
+    {
+        if (fgets(owner, sizeof(owner), comm)) owner[strcspn(owner, "\n")] = '\0';
+        fclose(comm);
+    }
+
+    for (int i = 0; i < SEQ_COORD_SLOTS; i++)
+    {
+        if (slots[i].pid == self) slots[i] = CoordSlot{};
+    }
+    int slot = 0;
+    for (auto& [cpu, utilization] : demand)
+    {
+        long long ppm = toPpm(utilization);
+        if (ppm <= 0) continue;
+        while (slots[slot].pid != 0) slot++;
+        slots[slot].cpu = cpu;
+        slots[slot].ppm = ppm;
+        memcpy(slots[slot].owner, owner, sizeof(owner));
+        slots[slot].pid = self;
+    }
+    unlock();
+    return true;
+}
+
+void ReleaseCoordinator::release()
+{
+    if (!header || !lock()) return;
+    pid_t self = getpid();
+    for (int i = 0; i < SEQ_COORD_SLOTS; i++)
+    {
+        if (slots[i].pid == self) slots[i] = CoordSlot{};
+    }
+    unlock();
+}
+
+std::map<int, double> ReleaseCoordinator::load()
+{
+    std::map<int, double> out;
+    if (!header || !lock()) return out;
+    pruneDead();
+    for (int i = 0; i < SEQ_COORD_SLOTS; i++)
+    {
+        if (slots[i].pid != 0) out[slots[i].cpu] += double(slots[i].ppm) / 1e6;
+    }
+    unlock();
+    return out;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <pthread.h>
+#include <sys/types.h>
+
+////////////////////////////////////////////
+// Multi-process release coordination
+////////////////////////////////////////////
+// Several Sequencer processes on one host (one per subsystem) join one POSIX
+// shared memory segment, /sequencer-coord by default (outside the
+// telemetry segments' "/sequencer.*", which SeqTelemetry scans), for two
+// things:
+//
+//  - A common time base. The segment holds an epoch and a grid on
+//    CLOCK_MONOTONIC; every process starts its releases on a grid boundary
+//    (epoch + k * grid) and times them with a CLOCK_MONOTONIC timer, so
+//    services with the same period release in phase across processes and
+//    never drift apart, and periods dividing the grid share its boundaries
+//    (hyperperiods, mode switches).
+//
+//  - A per-core utilization registry. At startServices() a process reserves
+//    what its pinned services need on each core (Sequencer::setExecBudget()
+//    / period); a reservation that would take a core past the limit fails
+//    and the process does not start. Reservations go at stopServices() or
+//    with the process: entries of dead processes are reclaimed.
+//
+// The first process to open the segment creates it and sets the epoch,
+// grid and limit; later ones use those (a different request is reported).
+// It also sets the segment's permissions: owner only by default, so other
+// users' processes join only if `mode` lets them (0660 for a shared group).
+// Only setup and teardown touch the segment's lock, never a release.
+
+#define SEQ_COORD_MAGIC   0x44524f43u   // "CORD"
+#define SEQ_COORD_VERSION 1u
+#define SEQ_COORD_SLOTS   256           // reservations, all processes together
+#define SEQ_COORD_NAME    32            // owner's program name, NUL padded
+
+struct CoordHeader
+{
+    uint32_t magic;           // SEQ_COORD_MAGIC, stored last by the creator
+    uint32_t version;         // SEQ_COORD_VERSION
+    uint32_t headerSize;      // sizeof(CoordHeader)
+    uint32_t slotSize;        // sizeof(CoordSlot)
+    uint32_t slotCount;       // SEQ_COORD_SLOTS
+    uint32_t reserved0;
+    int64_t  epochNs;         // CLOCK_MONOTONIC
+    int64_t  gridNs;
+    int64_t  limitPpm;        // per-core utilization limit, parts per million
+    pthread_mutex_t lock;     // process-shared, robust; guards the slots
+};
+
+struct CoordSlot
+{
+    int32_t pid;              // 0: free
+    int32_t cpu;
+    int64_t ppm;              // reserved utilization of `cpu`
+    char    owner[SEQ_COORD_NAME];
+};
+
+class ReleaseCoordinator
+{
+public:
+    // `grid`, `limit` (1.0 = a whole core) and `mode` (permissions, exactly,
+    // whatever the umask) apply if this process creates the segment
+    explicit ReleaseCoordinator(std::string name = "/sequencer-coord",
+                                std::chrono::nanoseconds grid = std::chrono::seconds(1), double limit = 1.0,
+                                mode_t mode = 0600);
+    ~ReleaseCoordinator();
+
+    ReleaseCoordinator(const ReleaseCoordinator&) = delete;
+    ReleaseCoordinator& operator=(const ReleaseCoordinator&) = delete;
+
+    // Join (or create) the segment. Returns false (and prints why) on failure.
+    bool open();
+
+    // The segment's grid and limit, once open
+    std::chrono::nanoseconds grid() const;
+    double limit() const;
+
+    // The first grid boundary at least `lead` from now (steady_clock, i.e.
+    // CLOCK_MONOTONIC)
+    std::chrono::steady_clock::time_point nextBoundary(std::chrono::nanoseconds lead) const;
+
+    // Reserve utilization per CPU for this process, all or nothing,
+    // replacing its previous reservation. False (and who holds the core)
+    // if a core would go past the limit or the registry is full.
+    bool reserve(const std::map<int, double>& demand);
+
+    // Drop this process's reservation
+    void release();
+
+    // Reserved utilization per CPU, all live processes
+    std::map<int, double> load();
+
+private:
+    std::string name;
+    std::chrono::nanoseconds requestedGrid;
+    double requestedLimit;
+    mode_t mode;
+    CoordHeader* header{nullptr};
+    CoordSlot* slots{nullptr};
+
+    bool create();
+    bool attach();
+    bool lock();
+    void unlock();
+    void pruneDead();
+};
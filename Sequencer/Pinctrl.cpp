@@ -0,0 +1,290 @@
+#include "Pinctrl.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+// BCM283x / BCM2711 GPIO register block (word offsets)
+#define GPIO_BLOCK_SIZE (4 * 1024)
+#define GPFSEL0  0   // 0x00 - function select, 10 pins per register
+#define GPSET0   7   // 0x1C - output set, pins 0..31 (GPSET1 follows)
+#define GPCLR0   10  // 0x28 - output clear, pins 0..31 (GPCLR1 follows)
+#define GPIO_MAX_PIN 57
+
+////////////////////////////////////////////
+// Command parsing
+////////////////////////////////////////////
+
+namespace
+{
+// Copy the next whitespace separated word of `*cursor` into `word`
+bool nextWord(const char** cursor, char* word, size_t size)
+{
+    const char* p = *cursor;
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    if (*p == '\0') return false;
+
+    size_t n = 0;
+    while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+    {
+        if (n + 1 < size) word[n++] = *p;
+        p++;
+    }
+    word[n] = '\0';
+    *cursor = p;
+    return true;
+}
+} // namespace
+
+bool parsePinctrlCommand(const char* text, PinctrlCommand& cmd)
+{
+    char word[16];
+    const char* cursor = text;
+    PinctrlCommand parsed;
+
+    if (!nextWord(&cursor, word, sizeof(word)))
+    {
+        std::cerr << "pinctrl: empty command\n";
+        return false;
+    }
+    if (strcmp(word, "pinctrl") == 0 && !nextWord(&cursor, word, sizeof(word)))
+    {
+        std::cerr << "pinctrl: empty command\n";
+        return false;
+    }
+    if (strcmp(word, "set") != 0)
+    {
+        std::cerr << "pinctrl: unsupported command '" << word << "' (only 'set')\n";
+        return false;
+    }
+
+    // Pin number
+    if (!nextWord(&cursor, word, sizeof(word)))
+    {
+        std::cerr << "pinctrl: missing pin in '" << text << "'\n";
+        return false;
+    }
+    char* end = nullptr;
+    long pin = strtol(word, &end, 10);
+    if (*end != '\0' || pin < 0 || pin > GPIO_MAX_PIN)
+    {
+        std::cerr << "pinctrl: bad pin '" << word << "'\n";
+        return false;
+    }
+    parsed.pin = static_cast<int>(pin);
+
+    // Function / drive options, in any order
+    while (nextWord(&cursor, word, sizeof(word)))
+    {
+        if (strcmp(word, "op") == 0)      parsed.func = PinctrlCommand::Func::Output;
+        else if (strcmp(word, "ip") == 0) parsed.func = PinctrlCommand::Func::Input;
+        else if (strcmp(word, "dh") == 0) parsed.drive = PinctrlCommand::Drive::High;
+        else if (strcmp(word, "dl") == 0) parsed.drive = PinctrlCommand::Drive::Low;
+        else
+        {
+            std::cerr << "pinctrl: unsupported option '" << word << "'\n";
+            return false;
+        }
+    }
+
+    cmd = parsed;
+    return true;
+}
+
+size_t formatPinctrlCommand(const PinctrlCommand& cmd, char* buf, size_t size)
+{
+    const char* func = cmd.func == PinctrlCommand::Func::Output ? " op"
+                     : cmd.func == PinctrlCommand::Func::Input  ? " ip" : "";
+    const char* drive = cmd.drive == PinctrlCommand::Drive::High ? " dh"
+                      : cmd.drive == PinctrlCommand::Drive::Low  ? " dl" : "";
+
+    int n = snprintf(buf, size, "set %d%s%s\n", cmd.pin, func, drive);
+    if (n < 0 || static_cast<size_t>(n) >= size) return 0;
+    return static_cast<size_t>(n);
+}
+
+////////////////////////////////////////////
+// Pinctrl
+////////////////////////////////////////////
+
+Pinctrl::Pinctrl(Mode mode, std::string gpiomemPath, std::string coprocessCmd)
+    : currentMode(mode),
+      gpiomemPath(std::move(gpiomemPath)),
+      coprocessCmd(std::move(coprocessCmd))
+{
+}
+
+Pinctrl::~Pinctrl()
+{
+    cleanup();
+}
+
+bool Pinctrl::init()
+{
+    return currentMode == Mode::Native ? initNative() : initCoprocess();
+}
+
+bool Pinctrl::run(const PinctrlCommand& cmd)
+{
+    bool ok = currentMode == Mode::Native ? runNative(cmd) : runCoprocess(cmd);
+    if (!ok) droppedCommands.fetch_add(1, std::memory_order_relaxed);
+    return ok;
+}
+
+bool Pinctrl::run(const char* text)
+{
+    PinctrlCommand cmd;
+    if (!parsePinctrlCommand(text, cmd)) return false;
+    return run(cmd);
+}
+
+void Pinctrl::cleanup()
+{
+    if (gpio)
+    {
+        munmap((void*)gpio, GPIO_BLOCK_SIZE);
+        gpio = nullptr;
+    }
+
+    if (coprocessFd >= 0)
+    {
+        // EOF on stdin ends the read loop
+        close(coprocessFd);
+        coprocessFd = -1;
+    }
+    if (coprocessPid > 0)
+    {
+        waitpid(coprocessPid, nullptr, 0);
+        coprocessPid = -1;
+    }
+}
+
+bool Pinctrl::initNative()
+{
+    int fd = open(gpiomemPath.c_str(), O_RDWR | O_SYNC);
+    if (fd < 0)
+    {
+        std::cerr << "pinctrl: open " << gpiomemPath << " failed: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    void* map = mmap(nullptr, GPIO_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "pinctrl: mmap " << gpiomemPath << " failed: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    gpio = reinterpret_cast<volatile uint32_t*>(map);
+    return true;
+}
+
+bool Pinctrl::initCoprocess()
+{
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0)
+    {
+        std::cerr << "pinctrl: pipe failed: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    // Child: stdin <- read end. dup2 clears O_CLOEXEC on fd 0 only.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+
+    const char* argv[] = {"/bin/sh", "-c", coprocessCmd.c_str(), nullptr};
+    int err = posix_spawn(&coprocessPid, "/bin/sh", &actions, nullptr,
+                          const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[0]);
+
+    if (err != 0)
+    {
+        std::cerr << "pinctrl: spawning coprocess failed: " << strerror(err) << "\n";
+        close(fds[1]);
+        coprocessPid = -1;
+        return false;
+    }
+
+    // Never let a stalled coprocess block the RT thread; a full pipe drops
+    // the command instead (counted by run()).
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    coprocessFd = fds[1];
+    return true;
+}
+
+bool Pinctrl::runNative(const PinctrlCommand& cmd)
+{
+    if (!gpio) return false;
+
+    if (cmd.func != PinctrlCommand::Func::Keep)
+    {
+        int reg = GPFSEL0 + cmd.pin / 10;
+        int shift = (cmd.pin % 10) * 3;
+        uint32_t value = gpio[reg];
+        value &= ~(0b111u << shift);
+        if (cmd.func == PinctrlCommand::Func::Output)
+        {
+            value |= (0b001u << shift);
+        }
+        gpio[reg] = value;
+    }
+
+    if (cmd.drive != PinctrlCommand::Drive::Keep)
+    {
+        int bank = cmd.pin / 32;
+        uint32_t bit = 1u << (cmd.pin % 32);
+        if (cmd.drive == PinctrlCommand::Drive::High)
+        {
+            gpio[GPSET0 + bank] = bit;
+        }
+        else
+        {
+            gpio[GPCLR0 + bank] = bit;
+        }
+    }
+    return true;
+}
+
+bool Pinctrl::runCoprocess(const PinctrlCommand& cmd)
+{
+    if (coprocessFd < 0) return false;
+
+    char line[32];
+    size_t len = formatPinctrlCommand(cmd, line, sizeof(line));
+    if (len == 0) return false;
+
+    // A dead coprocess should surface as EPIPE, not kill us: SIGPIPE stays
+    // blocked on this thread from its first command on
+    static thread_local bool sigpipeBlocked = false;
+    sigset_t sigpipe;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    if (!sigpipeBlocked)
+    {
+        pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+        sigpipeBlocked = true;
+    }
+
+    // Lines this short are written atomically to a pipe (< PIPE_BUF)
+    ssize_t n = write(coprocessFd, line, len);
+    if (n < 0 && errno == EPIPE)
+    {
+        // Take the SIGPIPE it left pending on this thread
+        timespec now{};
+        sigtimedwait(&sigpipe, nullptr, &now);
+    }
+    return n == static_cast<ssize_t>(len);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+////////////////////////////////////////////
+// pinctrl command vocabulary
+////////////////////////////////////////////
+// Mirrors the subset of `pinctrl set ...` our scripts use:
+//    set <pin> op          -> make pin an output
+//    set <pin> ip          -> make pin an input
+//    set <pin> dh / dl     -> drive pin high / low
+//    set <pin> op dh / dl  -> both at once
+// A leading "pinctrl" word is accepted so existing command strings can be
+// passed through unchanged.
+struct PinctrlCommand
+{
+    enum class Func { Keep, Output, Input };
+    enum class Drive { Keep, High, Low };
+
+    int pin{-1};
+    Func func{Func::Keep};
+    Drive drive{Drive::Keep};
+};
+
+// Parse `text` into `cmd`. Returns false (and prints why) on bad input.
+bool parsePinctrlCommand(const char* text, PinctrlCommand& cmd);
+
+// Write `cmd` back out as "set <pin> [op|ip] [dh|dl]\n". Returns the number of
+// characters written (excluding the terminator), or 0 if `size` is too small.
+size_t formatPinctrlCommand(const PinctrlCommand& cmd, char* buf, size_t size);
+
+////////////////////////////////////////////
+// In-process pinctrl
+////////////////////////////////////////////
+// Native mode maps the BCM283x/BCM2711 GPIO block through /dev/gpiomem (no
+// root needed, unlike /dev/mem in Method 4) and pokes the registers directly.
+//
+// Coprocess mode keeps compatibility with whatever `pinctrl` (or script) is
+// installed: one long-lived shell is spawned at init() and each command is
+// written to its stdin as a line, so the RT thread never forks. A command
+// the pipe cannot take (coprocess behind or dead) is dropped and counted in
+// dropped(). Threads that run commands in this mode get SIGPIPE blocked, so
+// a dead coprocess cannot kill the process; nothing else's signals change.
+class Pinctrl
+{
+public:
+    enum class Mode { Native, Coprocess };
+
+    // Reads "set ..." lines on stdin and hands each to the real pinctrl
+    static constexpr const char* defaultCoprocessCmd =
+        "while read -r line; do pinctrl $line; done";
+
+    explicit Pinctrl(Mode mode = Mode::Native,
+                     std::string gpiomemPath = "/dev/gpiomem",
+                     std::string coprocessCmd = defaultCoprocessCmd);
+    ~Pinctrl();
+
+    Pinctrl(const Pinctrl&) = delete;
+    Pinctrl& operator=(const Pinctrl&) = delete;
+
+    // Map the registers / spawn the coprocess. Call before starting RT threads.
+    bool init();
+
+    // Hot path: no allocation, no fork, no parsing. False (and counted in
+    // dropped()) if the command did not go out.
+    bool run(const PinctrlCommand& cmd);
+
+    // Convenience: parse then run. Prefer pre-parsing for periodic services.
+    bool run(const char* text);
+
+    // Unmap / close the pipe and reap the coprocess
+    void cleanup();
+
+    Mode mode() const { return currentMode; }
+
+    // Commands run() could not carry out, e.g. GPIO edges lost to a full
+    // pipe. Safe from any thread.
+    long long dropped() const { return droppedCommands.load(std::memory_order_relaxed); }
+
+private:
+    Mode currentMode;
+    std::string gpiomemPath;
+    std::string coprocessCmd;
+
+    // Native backend
+    volatile uint32_t* gpio{nullptr};
+
+    // Coprocess backend
+    int coprocessFd{-1};
+    pid_t coprocessPid{-1};
+
+    std::atomic<long long> droppedCommands{0};
+
+    bool initNative();
+    bool initCoprocess();
+    bool runNative(const PinctrlCommand& cmd);
+    bool runCoprocess(const PinctrlCommand& cmd);
+};
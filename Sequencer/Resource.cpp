@@ -0,0 +1,229 @@
+#include "Resource.hpp"
+#include <cerrno>
+#include <system_error>
+
+static void updateMax(std::atomic<long long>& max, long long ns)
+{
+    if (ns > max.load(std::memory_order_relaxed)) max.store(ns, std::memory_order_relaxed);
+}
+
+SharedResource::SharedResource(std::string name, ResourceProtocol protocol, int ceiling)
+    : resourceName(std::move(name)), resourceProtocol(protocol), fixedCeiling(ceiling)
+{
+    ceilingPriority = ceiling > 0 ? ceiling : sched_get_priority_min(SCHED_FIFO);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    int rc = pthread_mutexattr_setprotocol(&attr, protocol == ResourceProtocol::Inherit ? PTHREAD_PRIO_INHERIT
+                                                                                      : PTHREAD_PRIO_PROTECT);
+    if (rc == 0 && protocol == ResourceProtocol::Ceiling) rc = pthread_mutexattr_setprioceiling(&attr, ceilingPriority);
+    if (rc == 0) rc = pthread_mutex_init(&mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (rc != 0) fail(rc, "init");
+}
+
+SharedResource::~SharedResource()
+{
+    pthread_mutex_destroy(&mutex);
+}
+
+void SharedResource::declare(const Service& svc)
+{
+    if (useOf(&svc)) return;
+    users.push_back(std::make_unique<ResourceUse>());
+    users.back()->service = &svc;
+}
+
+bool SharedResource::applyCeiling()
+{
+    int highest = 0;
+    for (auto& use : users) highest = std::max(highest, use->service->highestPriority);
+    if (fixedCeiling > 0)
+    {
+        if (highest > fixedCeiling)
+        {
+            std::cerr << "Sequencer: resource " << resourceName << ": ceiling " << fixedCeiling
+                      << " is below its users' priority " << highest << "\n";
+            // Ceiling: locking it from above the ceiling fails (EINVAL)
+            if (resourceProtocol == ResourceProtocol::Ceiling) return false;
+        }
+        ceilingPriority = fixedCeiling;
+    }
+    else
+    {
+        ceilingPriority = std::clamp(highest, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+    }
+    if (resourceProtocol != ResourceProtocol::Ceiling) return true;
+
+    int old;
+    int rc = pthread_mutex_setprioceiling(&mutex, ceilingPriority, &old);
+    if (rc != 0)
+    {
+        std::cerr << "Sequencer: resource " << resourceName << ": cannot set ceiling " << ceilingPriority << ": "
+                  << std::generic_category().message(rc) << "\n";
+        return false;
+    }
+    return true;
+}
+
+ResourceUse* SharedResource::useOf(const Service* svc)
+{
+    for (auto& use : users)
+    {
+        if (use->service == svc) return use.get();
+    }
+    return nullptr;
+}
+
+void SharedResource::lock()
+{
+    Service* svc = Sequencer::currentJob;
+    int rc = pthread_mutex_trylock(&mutex);
+    if (rc == 0)
+    {
+        acquired(svc, 0);
+        return;
+    }
+    if (rc != EBUSY) fail(rc, "lock");
+
+    // Contended: only now is the wait worth two clock reads
+    long long start = Sequencer::jobNowNs(svc);
+    rc = pthread_mutex_lock(&mutex);
+    if (rc != 0) fail(rc, "lock");
+    acquired(svc, std::max(Sequencer::jobNowNs(svc) - start, 1LL));
+}
+
+bool SharedResource::try_lock()
+{
+    int rc = pthread_mutex_trylock(&mutex);
+    if (rc == EBUSY) return false;
+    if (rc != 0) fail(rc, "try_lock");
+    acquired(Sequencer::currentJob, 0);
+    return true;
+}
+
+void SharedResource::unlock()
+{
+    if (ResourceUse* use = holder)
+    {
+        long long heldNs = Sequencer::jobNowNs(use->service) - heldSinceNs;
+        use->totalHoldNs.fetch_add(heldNs, std::memory_order_relaxed);
+        updateMax(use->maxHoldNs, heldNs);
+        holder = nullptr;
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void SharedResource::acquired(Service* svc, long long blockedNs)
+{
+    if (!svc) return;  // not from a job: nothing to account to
+    svc->jobBlockingNs += blockedNs;
+
+    ResourceUse* use = useOf(svc);
+    if (!use)
+    {
+        undeclaredLocks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    use->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (blockedNs > 0)
+    {
+        use->contended.fetch_add(1, std::memory_order_relaxed);
+        use->totalBlockingNs.fetch_add(blockedNs, std::memory_order_relaxed);
+        updateMax(use->maxBlockingNs, blockedNs);
+    }
+    holder = use;
+    heldSinceNs = Sequencer::jobNowNs(svc);
+}
+
+void SharedResource::fail(int rc, const char* what) const
+{
+    throw std::system_error(rc, std::generic_category(), "SharedResource " + resourceName + ": " + what);
+}
+
+////////////////////////////////////////////
+// Response-time analysis
+////////////////////////////////////////////
+
+static bool shareCpu(const Service& a, const Service& b)
+{
+    return a.cpuAffinity < 0 || b.cpuAffinity < 0 || a.cpuAffinity == b.cpuAffinity;
+}
+
+// Does `j` delay `i` by preemption (rather than by blocking)? With modes,
+// if it may in any of them: j at its highest priority, i at its lowest.
+static bool interferes(const Service& j, const Service& i)
+{
+    return &j != &i && j.highestPriority >= i.lowestPriority && shareCpu(i, j);
+}
+
+std::vector<ResponseTimeBound> analyzeResponseTimes(const Sequencer& seq)
+{
+    std::vector<const Service*> all;
+    seq.visitServices([&](const Service& svc) { all.push_back(&svc); });
+
+    // Every resource any service declared
+    std::vector<const SharedResource*> resources;
+    for (const Service* svc : all)
+    {
+        for (const SharedResource* res : svc->resources)
+        {
+            if (std::find(resources.begin(), resources.end(), res) == resources.end()) resources.push_back(res);
+        }
+    }
+
+    std::vector<ResponseTimeBound> bounds;
+    for (const Service* svc : all)
+    {
+        long long periodNs = svc->periodNs.load(std::memory_order_relaxed);
+        if (periodNs <= 0) continue;
+
+        ResponseTimeBound b;
+        b.service = svc;
+        b.cpuNs = svc->stats.maxCpuNs.load(std::memory_order_relaxed);
+        b.deadlineNs = svc->relativeDeadline(periodNs).count();
+
+        // Blocking: the longest critical section per resource that can hold
+        // this service up, among users that do not already interfere
+        long long ceilingMax = 0, inheritSum = 0;
+        for (const SharedResource* res : resources)
+        {
+            if (res->ceiling() < svc->lowestPriority) continue;
+            long long longest = 0;
+            for (auto& use : res->uses())
+            {
+                if (use->service == svc || interferes(*use->service, *svc)) continue;
+                longest = std::max(longest, use->maxHoldNs.load(std::memory_order_relaxed));
+            }
+            if (res->protocol() == ResourceProtocol::Ceiling) ceilingMax = std::max(ceilingMax, longest);
+            else inheritSum += longest;
+        }
+        b.blockingNs = ceilingMax + inheritSum;
+
+        // Fixed point of R = C + B + I(R), given up past the deadline
+        long long response = b.cpuNs + b.blockingNs;
+        while (true)
+        {
+            long long interference = 0;
+            for (const Service* other : all)
+            {
+                long long otherPeriod = other->periodNs.load(std::memory_order_relaxed);
+                if (otherPeriod <= 0 || !interferes(*other, *svc)) continue;
+                long long releases = (response + otherPeriod - 1) / otherPeriod;
+                interference += releases * other->stats.maxCpuNs.load(std::memory_order_relaxed);
+            }
+            long long next = b.cpuNs + b.blockingNs + interference;
+            b.interferenceNs = interference;
+            if (next == response || next > b.deadlineNs)
+            {
+                response = next;
+                break;
+            }
+            response = next;
+        }
+        b.responseNs = response;
+        b.schedulable = response <= b.deadlineNs;
+        bounds.push_back(b);
+    }
+    return bounds;
+}
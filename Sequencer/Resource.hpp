@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Sequencer.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+////////////////////////////////////////////
+// Shared resources
+////////////////////////////////////////////
+// A mutex for state several services share (a device handle, a bus), with a
+// bounded priority inversion: a plain std::mutex lets a priority 97 holder
+// be preempted by anything in between while a priority 99 job waits for it.
+//
+//   ResourceProtocol::Inherit   PTHREAD_PRIO_INHERIT: the holder runs at the
+//                               priority of its highest waiter.
+//   ResourceProtocol::Ceiling   PTHREAD_PRIO_PROTECT: the holder runs at the
+//                               resource's ceiling while it holds it, so
+//                               nothing that could want it preempts it.
+//                               Needs RT privileges for every user, normal
+//                               threads included.
+//
+// Services declare what they use with Sequencer::useResource(); the default
+// ceiling is the highest priority among them in any operating mode, set by
+// startServices(), which refuses to start if a fixed Ceiling is lower. Jobs
+// then lock it like any mutex (std::lock_guard, std::scoped_lock). Time a
+// job waits for the lock adds to its blocking time (RTStatistics), and each
+// declared user's waits and critical sections are counted per resource for
+// analyzeResponseTimes(). Under Ceiling, a job kept off its CPU by a boosted
+// holder never waits on the lock: that shows as release jitter instead.
+//
+// Locking fails only on a misconfiguration (e.g. a Ceiling resource locked
+// above its ceiling); like std::mutex it throws std::system_error then.
+
+enum class ResourceProtocol
+{
+    Inherit,
+    Ceiling,
+};
+
+// One declared user's counters. Written by that service's worker only.
+struct ResourceUse
+{
+    const Service* service{nullptr};
+    std::atomic<long long> acquisitions{0};
+    std::atomic<long long> contended{0};       // had to wait for the lock
+    std::atomic<long long> totalBlockingNs{0};
+    std::atomic<long long> maxBlockingNs{0};
+    std::atomic<long long> totalHoldNs{0};     // lock -> unlock, preemption included
+    std::atomic<long long> maxHoldNs{0};
+};
+
+class SharedResource
+{
+public:
+    // ceiling 0: the highest priority (any mode) of the services that declare it
+    explicit SharedResource(std::string name, ResourceProtocol protocol = ResourceProtocol::Inherit,
+                            int ceiling = 0);
+    ~SharedResource();
+
+    SharedResource(const SharedResource&) = delete;
+    SharedResource& operator=(const SharedResource&) = delete;
+
+    // BasicLockable / Lockable
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    const std::string& name() const { return resourceName; }
+    ResourceProtocol protocol() const { return resourceProtocol; }
+
+    // The ceiling in effect (Ceiling), or the highest declared priority
+    // (Inherit), once startServices() ran
+    int ceiling() const { return ceilingPriority; }
+
+    // Per declaring service, in declaration order
+    const std::vector<std::unique_ptr<ResourceUse>>& uses() const { return users; }
+
+    // Locked by jobs of services that did not declare it (not analyzed)
+    std::atomic<long long> undeclaredLocks{0};
+
+private:
+    friend class Sequencer;
+
+    std::string resourceName;
+    ResourceProtocol resourceProtocol;
+    int fixedCeiling;
+    int ceilingPriority{0};
+    std::vector<std::unique_ptr<ResourceUse>> users;
+    pthread_mutex_t mutex;
+
+    // Owned by the holder
+    ResourceUse* holder{nullptr};
+    long long heldSinceNs{0};
+
+    // Sequencer::useResource() / startServices()
+    void declare(const Service& svc);
+    bool applyCeiling();
+
+    ResourceUse* useOf(const Service* svc);
+    void acquired(Service* svc, long long blockedNs);
+    [[noreturn]] void fail(int rc, const char* what) const;
+};
+
+////////////////////////////////////////////
+// Response-time analysis
+////////////////////////////////////////////
+// Fixed-priority response-time bound of every timed service, from what
+// its jobs did so far:
+//
+//   R = C + B + sum over hp of ceil(R / T_j) * C_j
+//
+// C is the service's largest CPU time per job, hp the services of higher or
+// equal priority that share its CPU (unpinned services share every CPU).
+// With operating modes, priorities are taken at their worst over the modes:
+// others at their highest, the service itself at its lowest.
+// B is its blocking term: for each resource with a ceiling at or above its
+// priority, the longest critical section of a user outside hp. Ceiling
+// resources block at most once per job (the longest of them counts),
+// Inherit ones once each (they add up). Critical sections are measured
+// lock to unlock, so preemption inside them makes B pessimistic, never
+// optimistic. Triggered services (period 0) have no T and are left out.
+struct ResponseTimeBound
+{
+    const Service* service{nullptr};
+    long long cpuNs{0};           // C
+    long long blockingNs{0};      // B
+    long long interferenceNs{0};  // at the fixed point
+    long long responseNs{0};      // R; past the deadline if it did not converge below it
+    long long deadlineNs{0};
+    bool schedulable{false};
+};
+
+std::vector<ResponseTimeBound> analyzeResponseTimes(const Sequencer& seq);
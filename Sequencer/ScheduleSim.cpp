@@ -0,0 +1,276 @@
+#include "ScheduleSim.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+////////////////////////////////////////////
+// Parsing
+////////////////////////////////////////////
+
+bool ExecModel::parse(const std::string& text, ExecModel& out)
+{
+    // kind:arg[:arg]
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true)
+    {
+        size_t colon = text.find(':', start);
+        parts.push_back(text.substr(start, colon - start));
+        if (colon == std::string::npos) break;
+        start = colon + 1;
+    }
+
+    ExecModel model;
+    size_t args;
+    if (parts[0] == "const")        { model.kind = Kind::Constant;    args = 1; }
+    else if (parts[0] == "uniform") { model.kind = Kind::Uniform;     args = 2; }
+    else if (parts[0] == "normal")  { model.kind = Kind::Normal;      args = 2; }
+    else if (parts[0] == "exp")     { model.kind = Kind::Exponential; args = 1; }
+    else
+    {
+        std::cerr << "exec model '" << text << "': unknown kind (const, uniform, normal, exp)\n";
+        return false;
+    }
+    if (parts.size() != args + 1 || !parseDuration(parts[1], model.a)
+        || (args == 2 && !parseDuration(parts[2], model.b)))
+    {
+        std::cerr << "exec model '" << text << "': expected " << parts[0]
+                  << (args == 2 ? ":<time>:<time>" : ":<time>") << "\n";
+        return false;
+    }
+    if (model.kind == Kind::Uniform && model.b < model.a)
+    {
+        std::cerr << "exec model '" << text << "': max below min\n";
+        return false;
+    }
+    out = model;
+    return true;
+}
+
+std::string ExecModel::describe() const
+{
+    auto us = [](std::chrono::nanoseconds d) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%gus", d.count() / 1e3);
+        return std::string(buf);
+    };
+    switch (kind)
+    {
+    case Kind::Constant:    return "const:" + us(a);
+    case Kind::Uniform:     return "uniform:" + us(a) + ":" + us(b);
+    case Kind::Normal:      return "normal:" + us(a) + ":" + us(b);
+    case Kind::Exponential: return "exp:" + us(a);
+    }
+    return "?";
+}
+
+long long SimServiceResult::quantile(const std::vector<long long>& sorted, double q)
+{
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(q * double(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+////////////////////////////////////////////
+// Simulation
+////////////////////////////////////////////
+
+namespace
+{
+struct SimJob
+{
+    size_t service;          // index into the specs
+    int priority;
+    long long releaseNs;     // planned release
+    long long deadlineNs;
+    long long remainingNs;   // execution time still to run
+    long long startNs{-1};   // first instruction, -1 until it runs
+};
+
+// One simulated CPU: its jobs, released and not yet finished
+struct SimCpu
+{
+    std::vector<SimJob> ready;
+    long long busyNs{0};
+};
+
+// SCHED_FIFO pick: highest priority, earliest release among equals (a
+// service's own queued job is always behind its running one)
+size_t pickJob(const std::vector<SimJob>& ready)
+{
+    size_t best = 0;
+    for (size_t i = 1; i < ready.size(); i++)
+    {
+        const SimJob& job = ready[i];
+        if (job.priority > ready[best].priority
+            || (job.priority == ready[best].priority && job.releaseNs < ready[best].releaseNs))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+long long sampleExec(const ExecModel& model, std::mt19937_64& rng)
+{
+    double ns = 0;
+    switch (model.kind)
+    {
+    case ExecModel::Kind::Constant:
+        ns = double(model.a.count());
+        break;
+    case ExecModel::Kind::Uniform:
+        ns = std::uniform_real_distribution<double>(double(model.a.count()), double(model.b.count()))(rng);
+        break;
+    case ExecModel::Kind::Normal:
+        ns = std::normal_distribution<double>(double(model.a.count()), double(model.b.count()))(rng);
+        break;
+    case ExecModel::Kind::Exponential:
+        ns = model.a.count() > 0 ? std::exponential_distribution<double>(1.0 / double(model.a.count()))(rng) : 0;
+        break;
+    }
+    // A job always takes some time
+    return std::max(1LL, static_cast<long long>(ns));
+}
+} // namespace
+
+ScheduleSim::ScheduleSim(std::vector<SimServiceSpec> services, std::chrono::microseconds masterInterval)
+    : specs(std::move(services)), masterInterval(masterInterval)
+{
+}
+
+std::chrono::microseconds ScheduleSim::hyperperiod() const
+{
+    long long h = masterInterval.count();
+    for (const SimServiceSpec& spec : specs)
+    {
+        long long p = spec.period.count();
+        if (p <= 0) continue;
+        long long g = std::gcd(h, p);
+        if (h / g > std::numeric_limits<long long>::max() / p) return std::chrono::microseconds(0);
+        h = h / g * p;
+    }
+    return std::chrono::microseconds(h);
+}
+
+SimResult ScheduleSim::run(std::chrono::nanoseconds duration, uint64_t seed) const
+{
+    SimResult result;
+    result.simulated = duration;
+
+    // The real release logic, in virtual time. The jobs never run there:
+    // stepVirtual() hands us the releases instead.
+    VirtualClock clock;
+    Sequencer seq;
+    seq.useVirtualClock(clock);
+    std::unordered_map<std::string, size_t> byName;
+    for (size_t i = 0; i < specs.size(); i++)
+    {
+        const SimServiceSpec& spec = specs[i];
+        seq.addService(spec.name, [] {}, spec.priority, spec.cpu, spec.period);
+        byName[spec.name] = i;
+
+        SimServiceResult r;
+        r.name = spec.name;
+        r.cpu = spec.cpu;
+        r.period = spec.period;
+        result.services.push_back(std::move(r));
+    }
+
+    // Pinned services on their CPU, unpinned ones together on "-1"
+    std::map<int, SimCpu> cpus;
+    for (const SimServiceSpec& spec : specs) cpus[spec.cpu < 0 ? -1 : spec.cpu];
+
+    std::mt19937_64 rng(seed);
+    std::unordered_map<const Service*, size_t> index;
+    auto released = [&](Service& svc) {
+        auto it = index.find(&svc);
+        if (it == index.end()) it = index.emplace(&svc, byName.at(svc.name)).first;
+        size_t i = it->second;
+        const SimServiceSpec& spec = specs[i];
+        SimServiceResult& r = result.services[i];
+        SimCpu& cpu = cpus[spec.cpu < 0 ? -1 : spec.cpu];
+
+        SimJob job{i, spec.priority,
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(svc.jobRelease.time_since_epoch()).count(),
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(svc.jobDeadline.time_since_epoch()).count(),
+                   sampleExec(spec.exec, rng)};
+        r.released++;
+
+        // At most one running and one queued job per service
+        bool running = false;
+        SimJob* queued = nullptr;
+        for (SimJob& other : cpu.ready)
+        {
+            if (other.service != i) continue;
+            if (other.startNs >= 0) running = true;
+            else queued = &other;
+        }
+        if (running) r.overruns++;
+        if (queued)
+        {
+            r.skipped++;  // the pending release stands, as in the mailbox
+        }
+        else
+        {
+            cpu.ready.push_back(job);
+        }
+    };
+    const std::function<void(Service&)> onRelease = released;
+
+    seq.startServices(masterInterval);
+    long long startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(clock.now().time_since_epoch()).count();
+    long long endNs = startNs + duration.count();
+
+    // Between two ticks nothing is released, so each CPU just runs its
+    // highest priority job until it finishes or the next tick comes
+    long long tickNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           seq.stepVirtual(onRelease).time_since_epoch()).count();
+    long long intervalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(masterInterval).count();
+    while (tickNs < endNs)
+    {
+        long long nextTickNs = std::min(tickNs + intervalNs, endNs);
+        for (auto& [id, cpu] : cpus)
+        {
+            long long now = tickNs;
+            while (now < nextTickNs && !cpu.ready.empty())
+            {
+                size_t pick = pickJob(cpu.ready);
+                SimJob& job = cpu.ready[pick];
+                if (job.startNs < 0) job.startNs = now;
+
+                long long slice = std::min(job.remainingNs, nextTickNs - now);
+                job.remainingNs -= slice;
+                now += slice;
+                cpu.busyNs += slice;
+                if (job.remainingNs > 0) continue;
+
+                SimServiceResult& r = result.services[job.service];
+                r.completed++;
+                if (now > job.deadlineNs) r.deadlineMisses++;
+                r.responseNs.push_back(now - job.releaseNs);
+                r.startDelayNs.push_back(std::max(0LL, job.startNs - job.releaseNs));
+                cpu.ready.erase(cpu.ready.begin() + static_cast<std::ptrdiff_t>(pick));
+            }
+        }
+        tickNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     seq.stepVirtual(onRelease).time_since_epoch()).count();
+    }
+    seq.stopServices();
+
+    for (SimServiceResult& r : result.services)
+    {
+        std::sort(r.responseNs.begin(), r.responseNs.end());
+        std::sort(r.startDelayNs.begin(), r.startDelayNs.end());
+    }
+    for (auto& [id, cpu] : cpus)
+    {
+        result.cpus.push_back({id, duration.count() > 0 ? double(cpu.busyNs) / double(duration.count()) : 0.0});
+    }
+    return result;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Sequencer.hpp"
+#include "ServiceConfig.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////
+// Offline schedule simulator
+////////////////////////////////////////////
+// Predicts response times and deadline misses of a service set before it is
+// deployed. Releases come from a Sequencer in virtual time, i.e. the real
+// onAlarm() and its master-tick quantization. Execution is simulated as
+// fixed-priority preemptive scheduling (SCHED_FIFO) per CPU, with each job's
+// execution time drawn from its service's ExecModel. Preemption happens at
+// master ticks, the only instants at which anything is released.
+//
+// Like a worker, a service runs its jobs one at a time: a release that finds
+// the previous job still running is queued behind it (an overrun), and one
+// that finds a queued job not yet started collapses into it (that release is
+// skipped; the queued job keeps its release, as in the worker's mailbox).
+//
+// Services with cpu -1 (unpinned) share one extra simulated CPU.
+
+// Execution time distribution of a service's jobs
+struct ExecModel
+{
+    enum class Kind { Constant, Uniform, Normal, Exponential };
+
+    Kind kind{Kind::Constant};
+    std::chrono::nanoseconds a{0};  // Constant: value. Uniform: min. Normal, Exponential: mean
+    std::chrono::nanoseconds b{0};  // Uniform: max. Normal: standard deviation
+
+    // "const:40us", "uniform:20us:60us", "normal:40us:5us", "exp:40us".
+    // Returns false (and prints why) on bad input.
+    static bool parse(const std::string& text, ExecModel& out);
+
+    // Back to the parse() syntax
+    std::string describe() const;
+};
+
+struct SimServiceSpec
+{
+    std::string name;
+    std::chrono::microseconds period{0};
+    int priority{0};
+    int cpu{-1};
+    ExecModel exec;
+};
+
+// Predicted behaviour of one service
+struct SimServiceResult
+{
+    std::string name;
+    int cpu{-1};
+    std::chrono::microseconds period{0};
+
+    long long released{0};        // releases by onAlarm()
+    long long completed{0};       // jobs that ran to completion
+    long long deadlineMisses{0};  // completed after their deadline
+    long long overruns{0};        // released while a job was still running
+    long long skipped{0};         // collapsed into a release not started yet
+
+    // Sorted, one entry per completed job (ns)
+    std::vector<long long> responseNs;    // planned release -> completion
+    std::vector<long long> startDelayNs;  // planned release -> first instruction
+
+    // Missed or skipped releases, over all releases
+    double missRate() const
+    {
+        return released == 0 ? 0.0 : double(deadlineMisses + skipped) / double(released);
+    }
+
+    // q in [0, 1]; 0 if nothing completed
+    static long long quantile(const std::vector<long long>& sorted, double q);
+};
+
+struct SimCpuResult
+{
+    int cpu{-1};
+    double utilization{0};  // busy time / simulated time
+};
+
+struct SimResult
+{
+    std::chrono::nanoseconds simulated{0};
+    std::vector<SimServiceResult> services;  // in spec order
+    std::vector<SimCpuResult> cpus;          // ascending, -1 (unpinned) first
+};
+
+class ScheduleSim
+{
+public:
+    // Service names must be unique
+    explicit ScheduleSim(std::vector<SimServiceSpec> services,
+                         std::chrono::microseconds masterInterval = std::chrono::milliseconds(1));
+
+    // After which the release pattern repeats: the least common multiple of
+    // the periods and the master interval. 0 if it overflows.
+    std::chrono::microseconds hyperperiod() const;
+
+    // Simulate `duration` of virtual time; execution times are drawn from a
+    // generator seeded with `seed`, so a run is reproducible
+    SimResult run(std::chrono::nanoseconds duration, uint64_t seed = 1) const;
+
+    const std::vector<SimServiceSpec>& services() const { return specs; }
+
+private:
+    std::vector<SimServiceSpec> specs;
+    std::chrono::microseconds masterInterval;
+};
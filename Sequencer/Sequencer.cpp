@@ -0,0 +1,2534 @@
+#include "Sequencer.hpp"
+#include "Channel.hpp"
+#include "Coordinator.hpp"
+#include "Resource.hpp"
+#include "Telemetry.hpp"
+#include <alloca.h>
+#include <cstdlib>
+#include <cstring>    // memset
+#include <cerrno>
+#include <fcntl.h>    // shm_open
+#include <linux/perf_event.h>
+#include <new>
+#include <numeric>    // std::gcd
+#include <malloc.h>   // mallopt
+#include <sys/mman.h> // mlockall
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>   // usleep
+
+Sequencer* Sequencer::gInstance = nullptr;
+thread_local Service* Sequencer::currentJob = nullptr;
+
+static long long steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static long long toNs(std::chrono::steady_clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+static std::chrono::steady_clock::time_point fromNs(long long ns)
+{
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(ns));
+}
+
+#ifdef SEQUENCER_ALLOC_GUARD
+////////////////////////////////////////////
+// Allocation guard (debug builds)
+////////////////////////////////////////////
+// Build with -DSEQUENCER_ALLOC_GUARD=1 to count every global operator new
+// made while a worker runs its job (RTStatistics::hotPathAllocs), or =2 to
+// abort on the first one.
+static thread_local std::atomic<long long>* rtAllocCounter = nullptr;
+
+// Null when out of memory; `align` 0 for the default alignment
+static void* guardedAlloc(std::size_t size, std::size_t align = 0) noexcept
+{
+    if (rtAllocCounter)
+    {
+        ++*rtAllocCounter;
+#if SEQUENCER_ALLOC_GUARD >= 2
+        static const char msg[] = "SEQUENCER_ALLOC_GUARD: operator new in an RT job\n";
+        [[maybe_unused]] ssize_t n = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+        std::abort();
+#endif
+    }
+    if (size == 0) size = 1;
+    if (align == 0) return std::malloc(size);
+    // aligned_alloc() wants a multiple of the alignment
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+static void* guardedNew(std::size_t size, std::size_t align = 0)
+{
+    void* p = guardedAlloc(size, align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) { return guardedNew(size); }
+void* operator new[](std::size_t size) { return guardedNew(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return guardedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return guardedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+// Over-aligned types (alignas beyond __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+void* operator new(std::size_t size, std::align_val_t al) { return guardedNew(size, std::size_t(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return guardedNew(size, std::size_t(al)); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return guardedAlloc(size, std::size_t(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return guardedAlloc(size, std::size_t(al));
+}
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+#endif
+
+// Touch `bytes` of stack below the caller so those pages are resident
+static void prefaultStack(size_t bytes)
+{
+    if (bytes == 0) return;
+    volatile char* buf = static_cast<volatile char*>(alloca(bytes));
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < bytes; i += static_cast<size_t>(pageSize))
+    {
+        buf[i] = 0;
+    }
+}
+
+// Page faults and context switches of the calling thread so far
+struct ThreadUsage
+{
+    long long minorFaults{0};
+    long long majorFaults{0};
+    long long voluntarySwitches{0};
+    long long involuntarySwitches{0};
+};
+
+static ThreadUsage threadUsage()
+{
+    ThreadUsage usage;
+    rusage ru;
+    if (getrusage(RUSAGE_THREAD, &ru) < 0) return usage;
+    usage.minorFaults = ru.ru_minflt;
+    usage.majorFaults = ru.ru_majflt;
+    usage.voluntarySwitches = ru.ru_nvcsw;
+    usage.involuntarySwitches = ru.ru_nivcsw;
+    return usage;
+}
+
+// Creates a SCHED_OTHER thread, whatever the calling thread runs as
+static int createNormalThread(pthread_t& thread, void* (*entry)(void*), void* arg)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    sched_param param{};
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+    int err = pthread_create(&thread, &attr, entry, arg);
+    pthread_attr_destroy(&attr);
+    return err;
+}
+
+////////////////////////////////////////////
+// Per-job performance counters (worker side)
+////////////////////////////////////////////
+
+namespace
+{
+int perfEventOpen(uint32_t type, uint64_t config, int groupFd, bool excludeKernel)
+{
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.pinned = groupFd < 0;  // the group is never multiplexed away
+    attr.exclude_kernel = excludeKernel;
+    attr.exclude_hv = 1;
+    // pid 0, cpu -1: the calling thread, wherever it runs
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+// Count the kernel side of the job too, unless perf_event_paranoid forbids it
+int openCounter(uint32_t type, uint64_t config, int groupFd)
+{
+    int fd = perfEventOpen(type, config, groupFd, false);
+    if (fd < 0 && (errno == EACCES || errno == EPERM))
+    {
+        fd = perfEventOpen(type, config, groupFd, true);
+    }
+    return fd;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Self-monitoring read of a hardware counter through its mmap page, without a
+// syscall (perf_event_open(2), "rdpmc"). False if the kernel does not allow it
+// right now; read() the group instead.
+bool rdpmcRead(const volatile perf_event_mmap_page* page, long long& value)
+{
+    uint32_t seq;
+    long long count;
+    do
+    {
+        seq = page->lock;
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        uint32_t index = page->index;
+        if (!page->cap_user_rdpmc || index == 0) return false;
+
+        uint32_t lo, hi;
+        __asm__ __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(index - 1));
+        int64_t pmc = static_cast<int64_t>((static_cast<uint64_t>(hi) << 32) | lo);
+        int width = page->pmc_width;
+        pmc = static_cast<int64_t>(static_cast<uint64_t>(pmc) << (64 - width)) >> (64 - width);
+        count = page->offset + pmc;
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+    } while (page->lock != seq);
+    value = count;
+    return true;
+}
+#endif
+
+// A worker's own counters: opened on its thread, closed when it exits
+class WorkerPerf
+{
+public:
+    static constexpr int HW = 3;  // Cycles, Instructions, CacheMisses
+    static constexpr int SW = 2;  // ContextSwitches, PageFaults
+
+    explicit WorkerPerf(PerfStats& stats) : stats(stats)
+    {
+        using Source = PerfStats::Source;
+        static const uint64_t hwConfig[HW] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                              PERF_COUNT_HW_CACHE_MISSES};
+        static const uint64_t swConfig[SW] = {PERF_COUNT_SW_CONTEXT_SWITCHES, PERF_COUNT_SW_PAGE_FAULTS};
+
+        // Hardware group, led by cycles
+        for (int i = 0; i < HW; i++)
+        {
+            int fd = openCounter(PERF_TYPE_HARDWARE, hwConfig[i], hwFd[0]);
+            if (fd < 0)
+            {
+                if (i == 0)
+                {
+                    stats.hardwareError = errno;
+                    break;
+                }
+                continue;
+            }
+            hwFd[i] = fd;
+            hwIndex[i] = hwCount++;
+            stats.source[i] = Source::Read;
+
+#if defined(__x86_64__) || defined(__i386__)
+            void* page = mmap(nullptr, static_cast<size_t>(sysconf(_SC_PAGESIZE)), PROT_READ, MAP_SHARED, fd, 0);
+            if (page != MAP_FAILED)
+            {
+                hwPage[i] = static_cast<perf_event_mmap_page*>(page);
+                long long probe;
+                if (rdpmcRead(hwPage[i], probe)) stats.source[i] = Source::Rdpmc;
+            }
+#endif
+        }
+
+        // Software group, led by context switches; getrusage() if perf is out
+        for (int i = 0; i < SW; i++)
+        {
+            int fd = openCounter(PERF_TYPE_SOFTWARE, swConfig[i], swFd[0]);
+            if (fd < 0)
+            {
+                if (i == 0) stats.softwareError = errno;
+                break;
+            }
+            swFd[i] = fd;
+            swCount++;
+        }
+        for (int i = 0; i < SW; i++)
+        {
+            stats.source[HW + i] = swFd[0] < 0 ? Source::Rusage : swFd[i] >= 0 ? Source::Read : Source::None;
+        }
+    }
+
+    ~WorkerPerf()
+    {
+        for (int i = 0; i < HW; i++)
+        {
+            if (hwPage[i]) munmap(hwPage[i], static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+            if (hwFd[i] >= 0) close(hwFd[i]);
+        }
+        for (int i = 0; i < SW; i++)
+        {
+            if (swFd[i] >= 0) close(swFd[i]);
+        }
+    }
+
+    void read(long long (&values)[PERF_COUNTERS])
+    {
+        using Source = PerfStats::Source;
+
+        // Hardware: rdpmc each, one group read() if any of them cannot
+        bool needRead = false;
+        for (int i = 0; i < HW; i++)
+        {
+            if (stats.source[i] == Source::Read) needRead = true;
+#if defined(__x86_64__) || defined(__i386__)
+            if (stats.source[i] == Source::Rdpmc && !rdpmcRead(hwPage[i], values[i])) needRead = true;
+#endif
+        }
+        if (needRead && readGroup(hwFd[0], hwCount))
+        {
+            for (int i = 0; i < HW; i++)
+            {
+                if (hwIndex[i] >= 0) values[i] = groupValues[hwIndex[i]];
+            }
+        }
+
+        // Software
+        if (swFd[0] >= 0)
+        {
+            if (readGroup(swFd[0], swCount))
+            {
+                for (int i = 0; i < swCount; i++) values[HW + i] = groupValues[i];
+            }
+        }
+        else
+        {
+            rusage ru;
+            if (getrusage(RUSAGE_THREAD, &ru) == 0)
+            {
+                values[HW + 0] = ru.ru_nvcsw + ru.ru_nivcsw;
+                values[HW + 1] = ru.ru_minflt + ru.ru_majflt;
+            }
+        }
+    }
+
+    void record(const long long (&before)[PERF_COUNTERS], const long long (&after)[PERF_COUNTERS])
+    {
+        for (int i = 0; i < PERF_COUNTERS; i++)
+        {
+            if (stats.source[i] == PerfStats::Source::None) continue;
+            long long delta = after[i] - before[i];
+            if (delta < 0) delta = 0;
+            stats.total[i].fetch_add(delta, std::memory_order_relaxed);
+            stats.perJob[i].add(delta);
+        }
+    }
+
+private:
+    PerfStats& stats;
+    int hwFd[HW] = {-1, -1, -1};
+    int hwIndex[HW] = {-1, -1, -1};  // position in the group read
+    int hwCount{0};
+    perf_event_mmap_page* hwPage[HW] = {};
+    int swFd[SW] = {-1, -1};
+    int swCount{0};
+
+    // PERF_FORMAT_GROUP: { nr, value[nr] }
+    long long groupBuffer[1 + HW];
+    const long long* groupValues{groupBuffer + 1};
+
+    bool readGroup(int leader, int count)
+    {
+        if (leader < 0) return false;
+        ssize_t want = static_cast<ssize_t>((1 + count) * sizeof(long long));
+        return ::read(leader, groupBuffer, sizeof(groupBuffer)) >= want;
+    }
+};
+} // namespace
+
+////////////////////////////////////////////
+// Constructors / Destructors
+////////////////////////////////////////////
+
+
+Sequencer::Sequencer()
+{
+     // Make this instance globally accessible for static signal handler
+    gInstance = this;
+}
+
+Sequencer::~Sequencer()
+{
+    // Ensure timer is torn down
+    stopServices();
+    teardownTelemetry();
+    // Unset the global pointer
+    gInstance = nullptr;
+}
+
+////////////////////////////////////////////
+// Public API
+////////////////////////////////////////////
+
+void Sequencer::setMemoryConfig(const MemoryConfig& cfg)
+{
+    memoryConfig = cfg;
+}
+
+void Sequencer::addService(std::string name, std::function<void()> func, int priority, int cpuAffinity, int periodMs)
+{
+    addService(std::move(name), std::move(func), priority, cpuAffinity,
+               std::chrono::milliseconds(periodMs));
+}
+
+void Sequencer::addService(std::string name, std::function<void()> func, int priority, int cpuAffinity,
+                           std::chrono::microseconds period)
+{
+    auto svc = std::make_unique<Service>();
+    svc->serviceFunc = std::move(func);
+    svc->name = std::move(name);
+    svc->priority = priority;
+    svc->highestPriority = priority;
+    svc->lowestPriority = priority;
+    svc->cpuAffinity = cpuAffinity;
+    svc->period = period;
+    svc->periodNs = std::chrono::duration_cast<std::chrono::nanoseconds>(period).count();
+
+    // The worker thread is created by startServices()
+    svc->owner = this;
+
+    services.push_back(std::move(svc));
+}
+
+void Sequencer::addService(std::string name, std::function<void(std::pmr::memory_resource&)> func,
+                           int priority, int cpuAffinity, std::chrono::microseconds period, size_t arenaBytes)
+{
+    addService(std::move(name), nullptr, priority, cpuAffinity, period);
+
+    // Set before startServices() creates the worker
+    Service& svc = *services.back();
+    svc.arenaServiceFunc = std::move(func);
+    svc.arenaBuffer = std::make_unique<std::byte[]>(arenaBytes);  // zeroed -> already faulted in
+    svc.arena = std::make_unique<std::pmr::monotonic_buffer_resource>(
+        svc.arenaBuffer.get(), arenaBytes, std::pmr::null_memory_resource());
+}
+
+bool Sequencer::startServices(int masterIntervalMs)
+{
+    return startServices(std::chrono::milliseconds(masterIntervalMs));
+}
+
+bool Sequencer::startServices(std::chrono::microseconds masterInterval)
+{
+    // sort services by period, low to high
+    std::sort(services.begin(), services.end(), [](const std::unique_ptr<Service>& a, const std::unique_ptr<Service>& b) {
+        return a->period < b->period;
+    });
+
+    // Triggered services (period 0) have no timeline to time themselves on
+    for (auto &svc : services)
+    {
+        if (svc->period.count() == 0 && svc->waitStrategy != WaitStrategy::Block)
+        {
+            std::cerr << "Sequencer: " << svc->name << " is triggered (period 0), it blocks until released\n";
+            svc->waitStrategy = WaitStrategy::Block;
+        }
+        svc->modePriority.store(svc->priority, std::memory_order_relaxed);
+    }
+    buildModeTables();
+
+    // Ceilings of the shared resources, from the priorities of their users
+    // in every mode. A job locking a Ceiling resource above its ceiling
+    // would fail, so that does not start.
+    for (auto &svc : services)
+    {
+        for (SharedResource* res : svc->resources)
+        {
+            if (!res->applyCeiling())
+            {
+                std::cerr << "Sequencer: resource ceilings do not fit, not starting services\n";
+                return false;
+            }
+        }
+    }
+
+    // Virtual time: nothing real-time to set up (see VirtualClock)
+    if (virtualClock)
+    {
+        startVirtual(masterInterval);
+        return true;
+    }
+
+    // Admission against the other Sequencer processes on this host, before
+    // anything is allocated or started
+    if (coordinator && !coordinator->reserve(cpuDemand()))
+    {
+        std::cerr << "Sequencer: a core would be overcommitted, not starting services\n";
+        return false;
+    }
+
+    // Window banks and counter stats are allocated now, so prepareMemory()
+    // locks them too
+    setupWindows();
+    for (auto &svc : services)
+    {
+        if (perfCounters && !svc->perf) svc->perf = std::make_unique<PerfStats>();
+    }
+
+    // Lock memory and prefault the heap before anything is released
+    prepareMemory();
+
+    // Forensics: the logger runs before any worker can miss
+    if (missForensics && !startMissLogger())
+    {
+        std::cerr << "Sequencer: continuing without deadline-miss forensics\n";
+    }
+
+    // Telemetry is not essential: without a segment we just run unobserved
+    if (!telemetryName.empty() && !telemetryHeader && !setupTelemetry())
+    {
+        std::cerr << "Sequencer: continuing without telemetry\n";
+    }
+
+    // Create the workers and wait until all of them are warm
+    if (!startWorkers())
+    {
+        std::cerr << "Sequencer: worker startup failed, not starting services\n";
+        stopServices();
+        return false;
+    }
+
+    // First release of each service at the first timer expiry, so the very
+    // first job is not counted as a full tick late. With a coordinator that
+    // is a boundary of the shared grid, in phase with the other processes.
+    auto now = coordinator ? coordinator->nextBoundary(masterInterval)
+                           : std::chrono::steady_clock::now() + masterInterval;
+    long long nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    buildReleaseTable(now);
+
+    // Setup signals and timer, unless every service times itself
+    running = true;
+    if (!releaseTable.service.empty() || !modes.empty())
+    {
+        setupTimer(masterInterval, now);
+    }
+
+    if (!windowLengths.empty() && !startWindowThread())
+    {
+        std::cerr << "Sequencer: continuing without windowed statistics\n";
+    }
+
+    if (telemetryHeader)
+    {
+        telemetryHeader->startNs = nowNs;
+        std::atomic_ref<uint32_t>(telemetryHeader->state).store(TELEMETRY_RUNNING, std::memory_order_release);
+    }
+
+    // Also handle Ctrl+C gracefully
+    struct sigaction saInt;
+    memset(&saInt, 0, sizeof(saInt));
+    saInt.sa_handler = Sequencer::sigintHandler;
+    sigaction(SIGINT, &saInt, nullptr);
+    return true;
+}
+
+void Sequencer::buildReleaseTable(std::chrono::steady_clock::time_point first)
+{
+    long long firstNs = std::chrono::duration_cast<std::chrono::nanoseconds>(first.time_since_epoch()).count();
+
+    // Rebuild the dispatcher's release table (Block services, period order;
+    // in virtual time every service)
+    releaseTable = ReleaseTable{};
+    for (auto &svc : services)
+    {
+        svc->firstRelease = first + svc->offset;
+
+        // Released by their triggers only
+        if (svc->period.count() == 0) continue;
+
+        if (svc->waitStrategy == WaitStrategy::Block || virtualClock)
+        {
+            // With modes the running mode's table releases it, if it has it
+            if (!modes.empty()) continue;
+
+            long long releaseNs = firstNs + svc->offset.count();
+            releaseTable.nextReleaseNs.push_back(releaseNs);
+            releaseTable.periodNs.push_back(svc->period.count());
+            releaseTable.service.push_back(svc.get());
+            releaseTable.earliestReleaseNs = std::min(releaseTable.earliestReleaseNs, releaseNs);
+        }
+        else
+        {
+            // Self-timed workers take it from here: open their start gate
+            svc->releaseSem.release();
+        }
+    }
+
+    // Modes: start in the requested one, or the first
+    activeTable = &releaseTable;
+    pendingMode.store(nullptr, std::memory_order_relaxed);
+    if (!modes.empty())
+    {
+        OperatingMode& mode = initialMode ? *initialMode : *modes.front();
+        scheduleMode(mode, firstNs);
+        enterMode(mode);
+    }
+}
+
+void Sequencer::stopServices()
+{
+    // Cancel timer
+    running = false;
+    teardownTimer();
+    stopWindowThread();
+    if (coordinator) coordinator->release();
+
+    // Mark keepRunning = false, release all semaphores
+    // (skip workers already joined, so a second stopServices() is harmless)
+    for (auto &svc : services)
+    {
+        if (!svc->workerStarted) continue;
+        svc->keepRunning = false;
+        // unblock the thread (a pending release wakes it already)
+        if (!svc->triggerPending.exchange(true, std::memory_order_acq_rel)) svc->releaseSem.release();
+    }
+
+    // Join all workers
+    for (auto &svc : services)
+    {
+        if (svc->workerStarted)
+        {
+            pthread_join(svc->worker, nullptr);
+            svc->workerStarted = false;
+        }
+    }
+
+    // Drain whatever misses the workers left behind
+    stopMissLogger();
+
+    if (telemetryHeader)
+    {
+        std::atomic_ref<uint32_t>(telemetryHeader->state).store(TELEMETRY_STOPPED, std::memory_order_release);
+    }
+}
+
+void Sequencer::onAlarm()
+{
+    // This is called each time SIGALRM fires (or a virtual tick is played)
+    long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(clockNow().time_since_epoch()).count();
+
+    // A requested mode switch, once its boundary is reached
+    OperatingMode* nextMode = pendingMode.load(std::memory_order_acquire);
+    if (nextMode && now >= nextMode->startNs)
+    {
+        enterMode(*nextMode);
+        pendingMode.store(nullptr, std::memory_order_release);
+        modeSwitches.fetch_add(1, std::memory_order_relaxed);
+    }
+    ReleaseTable& table = *activeTable;
+
+    // Common case for slow services: nothing is due this tick
+    if (now < table.earliestReleaseNs) return;
+
+    // Stage probe: reconstruct which timer expiry this tick belongs to
+    ReleaseStages stages;
+    if (stageProbe)
+    {
+        stages.onAlarmNs = now;
+        stages.handlerNs = handlerEntryNs;
+        long long sinceArmed = stages.handlerNs - timerArmedNs;
+        stages.timerExpiryNs = timerArmedNs + (sinceArmed / timerIntervalNs) * timerIntervalNs;
+    }
+
+    long long earliest = std::numeric_limits<long long>::max();
+    size_t count = table.nextReleaseNs.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        long long next = table.nextReleaseNs[i];
+
+        // Check if time to release
+        if (now >= next)
+        {
+            long long period = table.periodNs[i];
+            Service* svc = table.service[i];
+
+            // A period change (setPeriod()) starts with this job
+            long long newPeriod = svc->periodNs.load(std::memory_order_relaxed);
+            if (newPeriod != period)
+            {
+                period = newPeriod;
+                table.periodNs[i] = period;
+            }
+
+            // Still running the previous job: release it anyway (Queue) or
+            // drop this release (Skip)
+            bool release = true;
+            if (svc->jobActive.load(std::memory_order_relaxed))
+            {
+                svc->stats.overrunCount.fetch_add(1, std::memory_order_relaxed);
+                release = svc->overrunPolicy == OverrunPolicy::Queue;
+            }
+
+            // A release the worker has not picked up yet stands: this one
+            // collapses into it, and the mailbox is the worker's to copy
+            if (release && svc->triggerPending.exchange(true, std::memory_order_acq_rel))
+            {
+                svc->stats.collapsedCount.fetch_add(1, std::memory_order_relaxed);
+                release = false;
+            }
+
+            if (release)
+            {
+                // Hand the worker this job's planned release and deadline
+                svc->jobRelease = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next));
+                svc->jobDeadline = svc->jobRelease + svc->relativeDeadline(period);
+                if (stageProbe)
+                {
+                    svc->jobStages = stages;
+                    svc->jobStages.releaseNs = steadyNowNs();
+                }
+
+                // Release the service
+                if (virtualClock) svc->virtualReleased = true;
+                else svc->releaseSem.release();
+            }
+
+            // Update the next release. If we fell behind, skip the releases
+            // that are already past in one step.
+            next += period;
+            if (now >= next)
+            {
+                next += ((now - next) / period + 1) * period;
+            }
+            table.nextReleaseNs[i] = next;
+        }
+
+        earliest = std::min(earliest, next);
+    }
+    table.earliestReleaseNs = earliest;
+}
+
+void Sequencer::printStatistics()
+{
+    std::cout << "\n===== Final Statistics =====\n";
+    for (auto &svc : services)
+    {
+        auto &st = svc->stats;
+        std::cout << svc->name << ":\n"
+                  << "   ExecTime:   min=" << st.minExecNs.load() / 1e6 << " ms, "
+                  << "max=" << st.maxExecNs.load() / 1e6 << " ms, "
+                  << "avg=" << st.avgExecNs() / 1e6 << " ms, "
+                  << "p99=" << std::min(st.execHist.percentile(0.99), st.maxExecNs.load()) / 1e6 << " ms\n"
+                  << "   CpuTime:    min=" << st.minCpuNs.load() / 1e6 << " ms, "
+                  << "max=" << st.maxCpuNs.load() / 1e6 << " ms, "
+                  << "avg=" << st.avgCpuNs() / 1e6 << " ms, "
+                  << "p99=" << std::min(st.cpuHist.percentile(0.99), st.maxCpuNs.load()) / 1e6 << " ms\n"
+                  << "   Interfere:  min=" << st.minInterferenceNs.load() / 1e6 << " ms, "
+                  << "max=" << st.maxInterferenceNs.load() / 1e6 << " ms, "
+                  << "avg=" << st.avgInterferenceNs() / 1e6 << " ms, "
+                  << "p99=" << std::min(st.interferenceHist.percentile(0.99), st.maxInterferenceNs.load()) / 1e6 << " ms\n"
+                  << "   Response:   min=" << st.minResponseNs.load() / 1e6 << " ms, "
+                  << "max=" << st.maxResponseNs.load() / 1e6 << " ms, "
+                  << "avg=" << st.avgResponseNs() / 1e6 << " ms, "
+                  << "p99=" << std::min(st.responseHist.percentile(0.99), st.maxResponseNs.load()) / 1e6 << " ms\n"
+                  << "   ExecJitter: min=" << st.minExecJitterNs.load() / 1e6 << " ms, "
+                  << "max=" << st.maxExecJitterNs.load() / 1e6 << " ms, "
+                  << "avg=" << st.avgExecJitterNs() / 1e6 << " ms\n"
+                  << "   ReleaseJit: min=" << st.minReleaseJitterNs.load() / 1e6 << " ms, "
+                  << "max=" << st.maxReleaseJitterNs.load() / 1e6 << " ms, "
+                  << "avg=" << st.avgReleaseJitterNs() / 1e6 << " ms, "
+                  << "p99=" << std::min(st.releaseJitterHist.percentile(0.99), st.maxReleaseJitterNs.load()) / 1e6 << " ms\n"
+                  << "   Deadline Misses=" << st.deadlineMissCount.load()
+                  << ", Overruns=" << st.overrunCount.load()
+                  << " (collapsed=" << st.collapsedCount.load() << ")\n"
+                  << "   PageFaults: minor=" << st.minorFaults.load()
+                  << ", major=" << st.majorFaults.load()
+                  << " (startup minor=" << st.startupMinorFaults.load()
+                  << ", major=" << st.startupMajorFaults.load() << ")\n";
+        if (!svc->resources.empty() || st.maxBlockingNs.load() > 0)
+        {
+            std::cout << "   Blocking:   min=" << st.minBlockingNs.load() / 1e6 << " ms, "
+                      << "max=" << st.maxBlockingNs.load() / 1e6 << " ms, "
+                      << "avg=" << st.avgBlockingNs() / 1e6 << " ms, "
+                      << "p99=" << std::min(st.blockingHist.percentile(0.99), st.maxBlockingNs.load()) / 1e6 << " ms\n";
+        }
+        if (!svc->predecessors.empty())
+        {
+            std::string after;
+            for (Service* pred : svc->predecessors) after += (after.empty() ? "" : ", ") + pred->name;
+            std::cout << "   EndToEnd:   min=" << st.minEndToEndNs.load() / 1e6 << " ms, "
+                      << "max=" << st.maxEndToEndNs.load() / 1e6 << " ms, "
+                      << "avg=" << st.avgEndToEndNs() / 1e6 << " ms, "
+                      << "p99=" << std::min(st.endToEndHist.percentile(0.99), st.maxEndToEndNs.load()) / 1e6 << " ms"
+                      << " (after " << after << ")\n";
+        }
+        if (svc->arena)
+        {
+            std::cout << "   Arena Overflows=" << st.arenaOverflows.load() << "\n";
+        }
+#ifdef SEQUENCER_ALLOC_GUARD
+        std::cout << "   HotPath Allocs=" << st.hotPathAllocs.load() << "\n";
+#endif
+        if (svc->perf)
+        {
+            long long jobs = std::max(st.count.load(), 1LL);
+            std::cout << "   Perf/job:  ";
+            for (int i = 0; i < PERF_COUNTERS; i++)
+            {
+                if (!svc->perf->available(static_cast<PerfCounter>(i))) continue;
+                std::cout << " " << perfCounterNames[i] << " avg=" << double(svc->perf->total[i].load()) / double(jobs)
+                          << " p99=" << svc->perf->perJob[i].percentile(0.99) << ";";
+            }
+            if (svc->perf->available(PerfCounter::Cycles) && svc->perf->available(PerfCounter::Instructions)
+                && svc->perf->total[0].load() > 0)
+            {
+                std::cout << " IPC=" << double(svc->perf->total[1].load()) / double(svc->perf->total[0].load());
+            }
+            std::cout << "\n";
+        }
+    }
+    for (auto &[name, ch] : channels)
+    {
+        long long maxNs = ch->maxLatencyNs.load();
+        std::cout << "channel " << name << ":\n"
+                  << "   sent=" << ch->sent.load() << ", received=" << ch->received.load()
+                  << ", dropped=" << ch->dropped.load() << "\n"
+                  << "   Latency:    avg=" << ch->avgLatencyNs() / 1e6 << " ms, "
+                  << "p50=" << std::min(ch->latencyHist.percentile(0.50), maxNs) / 1e6 << " ms, "
+                  << "p99=" << std::min(ch->latencyHist.percentile(0.99), maxNs) / 1e6 << " ms, "
+                  << "max=" << maxNs / 1e6 << " ms\n";
+    }
+
+    // Shared resources, each once, and the response-time bounds they enter
+    std::vector<const SharedResource*> resources;
+    for (auto &svc : services)
+    {
+        for (const SharedResource* res : svc->resources)
+        {
+            if (std::find(resources.begin(), resources.end(), res) == resources.end()) resources.push_back(res);
+        }
+    }
+    for (const SharedResource* res : resources)
+    {
+        std::cout << "resource " << res->name() << " ("
+                  << (res->protocol() == ResourceProtocol::Ceiling ? "ceiling " : "inherit, highest user ")
+                  << res->ceiling() << "):\n";
+        for (auto &use : res->uses())
+        {
+            std::cout << "   " << use->service->name << ": locks=" << use->acquisitions.load()
+                      << ", contended=" << use->contended.load()
+                      << ", blocked max=" << use->maxBlockingNs.load() / 1e6 << " ms"
+                      << ", held max=" << use->maxHoldNs.load() / 1e6 << " ms\n";
+        }
+        if (res->undeclaredLocks.load() > 0)
+        {
+            std::cout << "   undeclared locks=" << res->undeclaredLocks.load() << "\n";
+        }
+    }
+    if (!resources.empty())
+    {
+        std::cout << "Response-time bounds (C = max CPU time, B = blocking, I = interference):\n";
+        for (const ResponseTimeBound& b : analyzeResponseTimes(*this))
+        {
+            std::cout << "   " << b.service->name << ": C=" << b.cpuNs / 1e6 << " ms, B=" << b.blockingNs / 1e6
+                      << " ms, I=" << b.interferenceNs / 1e6 << " ms, R=" << b.responseNs / 1e6 << " ms "
+                      << (b.schedulable ? "<= " : "> ") << "D=" << b.deadlineNs / 1e6 << " ms\n";
+        }
+    }
+    if (OperatingMode* mode = activeMode.load(std::memory_order_acquire))
+    {
+        std::cout << "mode " << mode->name << " (hyperperiod " << mode->hyperperiodNs / 1e6
+                  << " ms), switches=" << modeSwitches.load() << "\n";
+    }
+    std::cout << "============================\n\n";
+}
+
+bool Sequencer::setWaitStrategy(const std::string& name, WaitStrategy strategy, SpinConfig spin)
+{
+    for (auto &svc : services)
+    {
+        if (svc->name != name) continue;
+        // Read by the worker, which startServices() creates afterwards
+        svc->waitStrategy = strategy;
+        svc->spin = spin;
+        return true;
+    }
+    return false;
+}
+
+bool Sequencer::setReleaseTiming(const std::string& name, std::chrono::nanoseconds offset,
+                                 std::chrono::nanoseconds deadline)
+{
+    for (auto &svc : services)
+    {
+        if (svc->name != name) continue;
+        // Read by buildReleaseTable() and the release paths, all later
+        svc->offset = offset;
+        svc->deadline = deadline;
+        return true;
+    }
+    return false;
+}
+
+bool Sequencer::setOverrunPolicy(const std::string& name, OverrunPolicy policy)
+{
+    for (auto &svc : services)
+    {
+        if (svc->name != name) continue;
+        svc->overrunPolicy = policy;
+        return true;
+    }
+    return false;
+}
+
+bool Sequencer::setPeriod(const std::string& name, std::chrono::nanoseconds period)
+{
+    if (period.count() <= 0) return false;
+    for (auto &svc : services)
+    {
+        if (svc->name != name) continue;
+        // periodNs: once running, `period` is only what was set up
+        if (running && svc->periodNs.load(std::memory_order_relaxed) == 0) return false;
+        // Before the start nothing times the releases yet: take it now.
+        // Once running, the release timer picks it up (see periodNs).
+        if (!running) svc->period = period;
+        svc->periodNs.store(period.count(), std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+ServiceTrigger Sequencer::getTrigger(const std::string& name) const
+{
+    for (auto &svc : services)
+    {
+        if (svc->name == name && svc->periodNs.load(std::memory_order_relaxed) == 0) return ServiceTrigger(svc.get());
+    }
+    return ServiceTrigger();
+}
+
+bool ServiceTrigger::release() const
+{
+    return svc && svc->owner->triggerRelease(*svc);
+}
+
+bool Sequencer::triggerRelease(Service& svc, std::chrono::steady_clock::time_point chainRelease,
+                               std::chrono::steady_clock::time_point chainDeadline)
+{
+    if (!running.load(std::memory_order_relaxed)) return false;
+
+    if (svc.jobActive.load(std::memory_order_relaxed))
+    {
+        svc.stats.overrunCount.fetch_add(1, std::memory_order_relaxed);
+        if (svc.overrunPolicy == OverrunPolicy::Skip) return false;
+    }
+
+    // Released and not picked up yet: that job will see this input too.
+    // Otherwise we own the mailbox until the worker has copied it.
+    if (svc.triggerPending.exchange(true, std::memory_order_acq_rel)) return true;
+
+    svc.jobRelease = clockNow();
+    svc.jobChainRelease = chainRelease == std::chrono::steady_clock::time_point::min() ? svc.jobRelease
+                                                                                    : chainRelease;
+    auto deadline = svc.relativeDeadline(0);  // triggered: no period
+    svc.jobDeadline = deadline.count() > 0 ? svc.jobRelease + deadline : chainDeadline;
+    if (virtualClock) svc.virtualReleased = true;
+    else svc.releaseSem.release();
+    return true;
+}
+
+bool Sequencer::addDependency(const std::string& name, const std::string& after)
+{
+    Service* svc = nullptr;
+    Service* pred = nullptr;
+    for (auto &s : services)
+    {
+        if (s->name == name) svc = s.get();
+        if (s->name == after) pred = s.get();
+    }
+    if (!svc || !pred || svc == pred) return false;
+    if (std::find(pred->successors.begin(), pred->successors.end(), svc) != pred->successors.end()) return true;
+    if (svc->predecessors.size() == JOIN_MAX_PREDECESSORS)
+    {
+        std::cerr << "Sequencer: " << name << " already runs after " << JOIN_MAX_PREDECESSORS << " services\n";
+        return false;
+    }
+
+    // `after` must not already run after `name`
+    std::vector<const Service*> stack{svc};
+    while (!stack.empty())
+    {
+        const Service* s = stack.back();
+        stack.pop_back();
+        if (s == pred)
+        {
+            std::cerr << "Sequencer: " << name << " after " << after << " would close a cycle\n";
+            return false;
+        }
+        stack.insert(stack.end(), s->successors.begin(), s->successors.end());
+    }
+
+    pred->successors.push_back(svc);
+    svc->predecessors.push_back(pred);
+    svc->joinSlots = std::make_unique<Service::JoinSlot[]>(2 * svc->predecessors.size());
+    svc->period = std::chrono::nanoseconds(0);
+    svc->periodNs.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void Sequencer::finishChainJob(Service& svc, std::chrono::steady_clock::time_point chainRelease,
+                               std::chrono::steady_clock::time_point jobDeadline,
+                               std::chrono::steady_clock::time_point endTime)
+{
+    if (!svc.predecessors.empty())
+    {
+        svc.stats.updateEndToEnd(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - chainRelease).count());
+    }
+    for (Service* next : svc.successors)
+    {
+        if (next->predecessors.size() == 1)
+        {
+            triggerRelease(*next, chainRelease, jobDeadline);
+            continue;
+        }
+
+        // Join (see Service::joinState): the arrival that completes the set
+        // releases it and starts the next round
+        constexpr uint64_t roundBit = uint64_t(1) << JOIN_MAX_PREDECESSORS;
+        size_t n = next->predecessors.size();
+        size_t index = std::find(next->predecessors.begin(), next->predecessors.end(), &svc) - next->predecessors.begin();
+        uint64_t bit = uint64_t(1) << index;
+        uint64_t all = (uint64_t(1) << n) - 1;
+        uint64_t state = next->joinState.load(std::memory_order_acquire);
+        bool completes = false;
+        while (!(state & bit))
+        {
+            // Our slot of this round first, published by setting our bit. The
+            // round cannot flip before that: it needs our bit.
+            Service::JoinSlot& slot = next->joinSlots[(state & roundBit ? n : 0) + index];
+            slot.headNs.store(toNs(chainRelease), std::memory_order_relaxed);
+            slot.deadlineNs.store(toNs(jobDeadline), std::memory_order_relaxed);
+            completes = ((state | bit) & all) == all;
+            uint64_t desired = completes ? (state & roundBit) ^ roundBit : state | bit;
+            if (next->joinState.compare_exchange_weak(state, desired, std::memory_order_acq_rel)) break;
+            completes = false;
+        }
+        if (!completes) continue;  // waiting for others, or already in this round
+
+        long long headNs = std::numeric_limits<long long>::max();
+        long long deadlineNs = std::numeric_limits<long long>::max();
+        for (size_t i = 0; i < n; i++)
+        {
+            const Service::JoinSlot& slot = next->joinSlots[(state & roundBit ? n : 0) + i];
+            headNs = std::min(headNs, slot.headNs.load(std::memory_order_relaxed));
+            deadlineNs = std::min(deadlineNs, slot.deadlineNs.load(std::memory_order_relaxed));
+        }
+        triggerRelease(*next, fromNs(headNs), fromNs(deadlineNs));
+    }
+}
+
+void Sequencer::watchChannel(std::string name, const ChannelStats& stats)
+{
+    channels.emplace_back(std::move(name), &stats);
+}
+
+bool Sequencer::defineMode(const std::string& mode, std::vector<ModeService> entries)
+{
+    auto reject = [&](const std::string& why) {
+        std::cerr << "Sequencer: mode " << mode << ": " << why << "\n";
+        return false;
+    };
+    if (running) return reject("define modes before startServices()");
+    for (auto &m : modes)
+    {
+        if (m->name == mode) return reject("defined twice");
+    }
+
+    long long hyperperiod = 1;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const ModeService& entry = entries[i];
+        auto it = std::find_if(services.begin(), services.end(),
+                               [&](const std::unique_ptr<Service>& s) { return s->name == entry.name; });
+        if (it == services.end()) return reject("no service " + entry.name);
+        for (size_t j = 0; j < i; j++)
+        {
+            if (entries[j].name == entry.name) return reject(entry.name + " listed twice");
+        }
+        if ((*it)->period.count() == 0) return reject(entry.name + " is triggered (period 0)");
+        if (entry.period.count() <= 0) return reject(entry.name + ": the period must be positive");
+        if (entry.priority != 0 && ((*it)->priority <= 0 || entry.priority < sched_get_priority_min(SCHED_FIFO)
+                                    || entry.priority > sched_get_priority_max(SCHED_FIFO)))
+        {
+            return reject(entry.name + ": priority " + std::to_string(entry.priority)
+                          + " (SCHED_FIFO services only, 1-99)");
+        }
+
+        long long period = entry.period.count();
+        long long g = std::gcd(hyperperiod, period);
+        if (hyperperiod / g > std::numeric_limits<long long>::max() / period) return reject("hyperperiod overflows");
+        hyperperiod = hyperperiod / g * period;
+    }
+
+    auto m = std::make_unique<OperatingMode>();
+    m->name = mode;
+    m->services = std::move(entries);
+    m->hyperperiodNs = hyperperiod;
+    modes.push_back(std::move(m));
+    return true;
+}
+
+bool Sequencer::requestMode(const std::string& mode)
+{
+    std::lock_guard<std::mutex> lock(modeLock);
+    auto it = std::find_if(modes.begin(), modes.end(),
+                           [&](const std::unique_ptr<OperatingMode>& m) { return m->name == mode; });
+    if (it == modes.end()) return false;
+    OperatingMode* next = it->get();
+
+    // Not running yet: start in it
+    if (!running)
+    {
+        initialMode = next;
+        return true;
+    }
+    if (pendingMode.load(std::memory_order_acquire)) return false;
+    OperatingMode* current = activeMode.load(std::memory_order_acquire);
+    if (next == current) return true;
+
+    // The running mode's next boundary that no tick has passed yet; the
+    // new table is written before onAlarm() can see it
+    long long now = toNs(clockNow());
+    long long hyperperiod = current->hyperperiodNs;
+    long long boundary = current->startNs + ((now - current->startNs) / hyperperiod + 1) * hyperperiod;
+    long long margin = virtualClock ? 0 : timerIntervalNs;
+    if (boundary - now < margin) boundary += (margin - (boundary - now) + hyperperiod - 1) / hyperperiod * hyperperiod;
+    scheduleMode(*next, boundary);
+    pendingMode.store(next, std::memory_order_release);
+    return true;
+}
+
+std::string Sequencer::currentMode() const
+{
+    OperatingMode* mode = activeMode.load(std::memory_order_acquire);
+    return mode ? mode->name : std::string();
+}
+
+void Sequencer::buildModeTables()
+{
+    for (auto &svc : services)
+    {
+        svc->highestPriority = svc->priority;
+        svc->lowestPriority = svc->priority;
+    }
+    for (auto &mode : modes)
+    {
+        // Period order, as the release table without modes
+        std::stable_sort(mode->services.begin(), mode->services.end(),
+                         [](const ModeService& a, const ModeService& b) { return a.period < b.period; });
+
+        mode->table = ReleaseTable{};
+        mode->priority.clear();
+        std::vector<ModeService> kept;
+        for (const ModeService& entry : mode->services)
+        {
+            Service* svc = nullptr;
+            for (auto &s : services)
+            {
+                if (s->name == entry.name) svc = s.get();
+            }
+            if (!svc)
+            {
+                std::cerr << "Sequencer: mode " << mode->name << ": no service " << entry.name << ", left out\n";
+                continue;
+            }
+            // addDependency() after defineMode(): released by its predecessors
+            if (!svc->predecessors.empty())
+            {
+                std::cerr << "Sequencer: mode " << mode->name << ": " << entry.name
+                          << " runs after other services, left out\n";
+                continue;
+            }
+            if (svc->waitStrategy != WaitStrategy::Block && !virtualClock)
+            {
+                std::cerr << "Sequencer: mode " << mode->name << ": " << entry.name
+                          << " is not released by the timer (WaitStrategy), left out\n";
+                continue;
+            }
+            mode->table.nextReleaseNs.push_back(0);
+            mode->table.periodNs.push_back(entry.period.count());
+            mode->table.service.push_back(svc);
+            mode->priority.push_back(entry.priority != 0 ? entry.priority : svc->priority);
+            svc->highestPriority = std::max(svc->highestPriority, mode->priority.back());
+            svc->lowestPriority = std::min(svc->lowestPriority, mode->priority.back());
+            kept.push_back(entry);
+        }
+        mode->services = std::move(kept);
+    }
+}
+
+void Sequencer::scheduleMode(OperatingMode& mode, long long startNs)
+{
+    ReleaseTable& table = mode.table;
+    table.earliestReleaseNs = std::numeric_limits<long long>::max();
+    for (size_t i = 0; i < table.service.size(); i++)
+    {
+        // Its own periods again, whatever setPeriod() did last time
+        table.periodNs[i] = mode.services[i].period.count();
+        table.nextReleaseNs[i] = startNs + table.service[i]->offset.count();
+        table.earliestReleaseNs = std::min(table.earliestReleaseNs, table.nextReleaseNs[i]);
+    }
+    mode.startNs = startNs;
+}
+
+void Sequencer::enterMode(OperatingMode& mode)
+{
+    ReleaseTable& table = mode.table;
+    for (size_t i = 0; i < table.service.size(); i++)
+    {
+        Service* svc = table.service[i];
+        svc->periodNs.store(table.periodNs[i], std::memory_order_relaxed);
+        svc->modePriority.store(mode.priority[i], std::memory_order_relaxed);
+    }
+    activeTable = &table;
+    activeMode.store(&mode, std::memory_order_release);
+}
+
+bool Sequencer::useResource(const std::string& name, SharedResource& resource)
+{
+    for (auto &svc : services)
+    {
+        if (svc->name != name) continue;
+        if (std::find(svc->resources.begin(), svc->resources.end(), &resource) == svc->resources.end())
+        {
+            svc->resources.push_back(&resource);
+            resource.declare(*svc);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool Sequencer::setExecBudget(const std::string& name, std::chrono::nanoseconds budget)
+{
+    if (budget.count() < 0) return false;
+    for (auto &svc : services)
+    {
+        if (svc->name != name) continue;
+        svc->budget = budget;
+        return true;
+    }
+    return false;
+}
+
+void Sequencer::useCoordinator(ReleaseCoordinator& coordinator)
+{
+    this->coordinator = &coordinator;
+}
+
+// Utilization per CPU of the pinned services with a budget, at their
+// shortest period in any mode
+std::map<int, double> Sequencer::cpuDemand() const
+{
+    std::map<int, double> demand;
+    for (auto &svc : services)
+    {
+        if (svc->cpuAffinity < 0 || svc->budget.count() == 0) continue;
+        long long periodNs = svc->periodNs.load(std::memory_order_relaxed);
+        for (auto &mode : modes)
+        {
+            for (size_t i = 0; i < mode->table.service.size(); i++)
+            {
+                if (mode->table.service[i] != svc.get()) continue;
+                long long modePeriod = mode->table.periodNs[i];
+                periodNs = periodNs > 0 ? std::min(periodNs, modePeriod) : modePeriod;
+            }
+        }
+        // Triggered (period 0): no rate of its own, its deadline stands in
+        if (periodNs <= 0) periodNs = svc->deadline.count();
+        if (periodNs <= 0)
+        {
+            std::cerr << "Sequencer: " << svc->name << " has no period or deadline, its budget is not reserved\n";
+            continue;
+        }
+        demand[svc->cpuAffinity] += double(svc->budget.count()) / double(periodNs);
+    }
+    return demand;
+}
+
+long long Sequencer::jobNowNs(const Service* svc)
+{
+    if (!svc || !svc->owner) return steadyNowNs();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(svc->owner->clockNow().time_since_epoch()).count();
+}
+
+void Sequencer::enableTelemetry(std::string shmName)
+{
+    telemetryName = shmName.empty() ? "/sequencer." + std::to_string(getpid()) : std::move(shmName);
+}
+
+void Sequencer::enableWindows(std::vector<std::chrono::milliseconds> lengths)
+{
+    lengths.erase(std::remove_if(lengths.begin(), lengths.end(),
+                                 [](std::chrono::milliseconds l) { return l.count() <= 0; }),
+                  lengths.end());
+    std::sort(lengths.begin(), lengths.end());
+
+    // Longer windows are built from whole base windows
+    for (auto &length : lengths)
+    {
+        length = (length / lengths.front()) * lengths.front();
+    }
+    lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+    windowLengths = std::move(lengths);
+}
+
+bool Sequencer::getWindow(const std::string& name, size_t window, WindowSummary& out) const
+{
+    for (auto &svc : services)
+    {
+        if (svc->name == name) return svc->windows && svc->windows->last(window, out);
+    }
+    return false;
+}
+
+void Sequencer::enablePerfCounters()
+{
+    perfCounters = true;
+}
+
+void Sequencer::useVirtualClock(VirtualClock& clock)
+{
+    virtualClock = &clock;
+}
+
+void Sequencer::startVirtual(std::chrono::microseconds masterInterval)
+{
+    // A tick runs the released jobs highest priority first, at their
+    // priorities in the running mode (see stepVirtual()); equal priorities
+    // keep period order
+    virtualOrder.clear();
+    for (auto &svc : services) virtualOrder.push_back(svc.get());
+
+    virtualInterval = masterInterval;
+    nextVirtualTick = virtualClock->now() + masterInterval;
+    buildReleaseTable(nextVirtualTick);
+    running = true;
+}
+
+void Sequencer::simulateUntil(std::chrono::steady_clock::time_point until)
+{
+    if (!virtualClock || !running) return;
+
+    const std::function<void(Service&)> run = [this](Service& svc) { runVirtualJob(svc); };
+    while (nextVirtualTick <= until)
+    {
+        stepVirtual(run);
+    }
+    virtualClock->advanceTo(until);
+}
+
+std::chrono::steady_clock::time_point Sequencer::stepVirtual(const std::function<void(Service&)>& released)
+{
+    if (!virtualClock || !running) return clockNow();
+
+    // Expiries that passed while a job ran come as one late tick, like the
+    // POSIX timer's overrun
+    auto now = virtualClock->now();
+    if (now > nextVirtualTick)
+    {
+        nextVirtualTick += ((now - nextVirtualTick) / virtualInterval) * virtualInterval;
+    }
+    virtualClock->advanceTo(nextVirtualTick);
+    nextVirtualTick += virtualInterval;
+
+    onAlarm();
+
+    // One at a time, highest priority first, until none is left: a job may
+    // release a successor (see addDependency()), which still runs this tick
+    while (true)
+    {
+        Service* next = nullptr;
+        for (Service* svc : virtualOrder)
+        {
+            if (!svc->virtualReleased) continue;
+            if (!next || svc->modePriority.load(std::memory_order_relaxed)
+                             > next->modePriority.load(std::memory_order_relaxed))
+            {
+                next = svc;
+            }
+        }
+        if (!next) break;
+        next->virtualReleased = false;
+        next->triggerPending.store(false, std::memory_order_release);
+        released(*next);
+    }
+    return virtualClock->now();
+}
+
+void Sequencer::runVirtualJob(Service& svc)
+{
+    auto jobRelease = svc.jobRelease;
+    auto jobDeadline = svc.jobDeadline;
+    auto chainRelease = !svc.predecessors.empty() ? svc.jobChainRelease : jobRelease;
+
+    auto startTime = virtualClock->now();
+    auto relJitterNs = std::chrono::duration_cast<std::chrono::nanoseconds>(startTime - jobRelease).count();
+    svc.stats.updateReleaseJitter(relJitterNs < 0 ? 0 : relJitterNs);
+
+    runJob(svc);
+    auto endTime = virtualClock->now();
+
+    // Nothing preempts a virtual job: its CPU time is its exec time
+    long long execTimeNs;
+    recordJob(svc, jobRelease, jobDeadline, startTime, endTime,
+              std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count(), execTimeNs);
+    finishChainJob(svc, chainRelease, jobDeadline, endTime);
+
+    // The ticks of releases that came due after this one are played only
+    // now, so do what onAlarm() would have done with them in real time.
+    // Due before the job started: they collapse into its release. Due while
+    // it ran: overruns, of which the first is queued and the rest collapse
+    // (Queue), or all are dropped (Skip).
+    ReleaseTable& table = *activeTable;
+    for (size_t i = 0; i < table.service.size(); i++)
+    {
+        if (table.service[i] != &svc) continue;
+        long long next = table.nextReleaseNs[i];
+        long long period = table.periodNs[i];
+        long long start = toNs(startTime);
+        long long end = toNs(endTime);
+        if (period <= 0) break;
+        if (next < start)
+        {
+            long long pending = (start - next - 1) / period + 1;
+            svc.stats.collapsedCount.fetch_add(pending, std::memory_order_relaxed);
+            next += pending * period;
+        }
+        if (next < end)
+        {
+            long long due = (end - next - 1) / period + 1;
+            svc.stats.overrunCount.fetch_add(due, std::memory_order_relaxed);
+            if (svc.overrunPolicy == OverrunPolicy::Queue)
+            {
+                svc.stats.collapsedCount.fetch_add(due - 1, std::memory_order_relaxed);
+            }
+            else
+            {
+                next += due * period;
+            }
+        }
+        table.nextReleaseNs[i] = next;
+        break;
+    }
+}
+
+void Sequencer::enableMissForensics(std::string logPath)
+{
+    missForensics = true;
+    missLogPath = std::move(logPath);
+}
+
+void Sequencer::setStrictRealTime(bool strict)
+{
+    strictRealTime = strict;
+}
+
+void Sequencer::setShutdownHook(std::function<void()> hook)
+{
+    shutdownHook = std::move(hook);
+}
+
+void Sequencer::setStageProbe(std::function<void(const Service&, const ReleaseStages&)> probe)
+{
+    stageProbe = std::move(probe);
+}
+
+const RTStatistics* Sequencer::getStatistics(const std::string& name) const
+{
+    for (auto &svc : services)
+    {
+        if (svc->name == name) return &svc->stats;
+    }
+    return nullptr;
+}
+
+void Sequencer::visitServices(const std::function<void(const Service&)>& visit) const
+{
+    for (auto &svc : services)
+    {
+        visit(*svc);
+    }
+}
+
+////////////////////////////////////////////
+// Private / static
+////////////////////////////////////////////
+
+void Sequencer::runWorker(Service& svc)
+{
+    // Report what we actually got; startServices() checks it before the
+    // first release
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &svc.runningPolicy, &param);
+    svc.runningPriority = param.sched_priority;
+    svc.appliedModePriority = svc.runningPriority;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    svc.runningPinned = pthread_getaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0
+                        && svc.cpuAffinity >= 0 && CPU_COUNT(&cpuset) == 1
+                        && CPU_ISSET(svc.cpuAffinity, &cpuset);
+
+    // Make the stack the loop will use resident before the first release
+    size_t prefaultBytes = std::min(memoryConfig.stackPrefaultBytes,
+                                    memoryConfig.workerStackSize / 2);
+    prefaultStack(prefaultBytes);
+    ThreadUsage seen = threadUsage();
+    svc.stats.startupMinorFaults = seen.minorFaults;
+    svc.stats.startupMajorFaults = seen.majorFaults;
+    svc.tid = gettid();
+
+    // Counters follow this thread, so it opens them itself
+    std::unique_ptr<WorkerPerf> perf;
+    if (svc.perf) perf = std::make_unique<WorkerPerf>(*svc.perf);
+
+    // Warm: let startServices() go on
+    startLatch->count_down();
+
+    // Keep running until told otherwise
+    while (svc.keepRunning)
+    {
+        // Wait for release
+        if (!waitForRelease(svc)) break;
+
+        // Mark release time
+        auto releaseTime = std::chrono::steady_clock::now();
+        svc.jobActive.store(true, std::memory_order_relaxed);
+
+        // A mode switch changed our priority
+        if (svc.modePriority.load(std::memory_order_relaxed) != svc.appliedModePriority) applyModePriority(svc);
+        if (stageProbe) svc.jobStages.wakeNs = steadyNowNs();
+
+        // Our copy of this job: an overrun's release rewrites the mailbox
+        auto jobRelease = svc.jobRelease;
+        auto jobDeadline = svc.jobDeadline;
+        auto chainRelease = !svc.predecessors.empty() ? svc.jobChainRelease : jobRelease;
+        svc.triggerPending.store(false, std::memory_order_release);
+
+        // Calculate release jitter vs. the planned release of this job
+        auto relJitterNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                releaseTime - jobRelease).count();
+        svc.stats.updateReleaseJitter(relJitterNs < 0 ? 0 : relJitterNs);
+
+        // Forensics: context switches from here, and our slot in the trace ring
+        ThreadUsage usageBefore;
+        JobTraceSlot* trace = nullptr;
+        if (missQueue)
+        {
+            usageBefore = threadUsage();
+            trace = beginJobTrace(svc);
+        }
+
+        long long perfBefore[PERF_COUNTERS] = {};
+        if (perf) perf->read(perfBefore);
+
+        // Run the service function
+        if (stageProbe) svc.jobStages.startNs = steadyNowNs();
+        timespec cpuStart, cpuEnd;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+        auto startTime = std::chrono::steady_clock::now();
+        runJob(svc);
+        auto endTime = std::chrono::steady_clock::now();
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+
+        if (perf)
+        {
+            long long perfAfter[PERF_COUNTERS] = {};
+            perf->read(perfAfter);
+            perf->record(perfBefore, perfAfter);
+        }
+        if (trace) trace->endNs.store(steadyNowNs(), std::memory_order_relaxed);
+
+        // Execution time, CPU time, response time, deadline
+        long long cpuTimeNs = (cpuEnd.tv_sec - cpuStart.tv_sec) * 1000000000LL + (cpuEnd.tv_nsec - cpuStart.tv_nsec);
+        long long execTimeNs;
+        bool missed = recordJob(svc, jobRelease, jobDeadline, startTime, endTime, cpuTimeNs, execTimeNs);
+        svc.jobActive.store(false, std::memory_order_relaxed);
+        finishChainJob(svc, chainRelease, jobDeadline, endTime);
+
+        if (svc.windows) svc.windows->record(execTimeNs, relJitterNs < 0 ? 0 : relJitterNs);
+        if (svc.telemetry) publishTelemetry(svc, jobRelease, relJitterNs, execTimeNs, missed);
+
+        if (stageProbe) stageProbe(svc, svc.jobStages);
+
+        // Faults since the last job (outside the timed region)
+        ThreadUsage usage = threadUsage();
+        svc.stats.minorFaults += usage.minorFaults - seen.minorFaults;
+        svc.stats.majorFaults += usage.majorFaults - seen.majorFaults;
+        seen = usage;
+
+        if (missed && missQueue)
+        {
+            MissRecord rec;
+            rec.service = &svc;
+            rec.job = svc.stats.count.load(std::memory_order_relaxed);
+            rec.cpu = trace->cpu.load(std::memory_order_relaxed);
+            rec.tid = svc.tid;
+            rec.releaseNs = std::chrono::duration_cast<std::chrono::nanoseconds>(jobRelease.time_since_epoch()).count();
+            rec.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(startTime.time_since_epoch()).count();
+            rec.endNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime.time_since_epoch()).count();
+            rec.deadlineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(jobDeadline.time_since_epoch()).count();
+            rec.voluntarySwitches = usage.voluntarySwitches - usageBefore.voluntarySwitches;
+            rec.involuntarySwitches = usage.involuntarySwitches - usageBefore.involuntarySwitches;
+            captureMiss(rec);
+        }
+    }
+}
+
+bool Sequencer::recordJob(Service& svc, std::chrono::steady_clock::time_point jobRelease,
+                          std::chrono::steady_clock::time_point jobDeadline,
+                          std::chrono::steady_clock::time_point startTime,
+                          std::chrono::steady_clock::time_point endTime, long long cpuTimeNs,
+                          long long& execTimeNs)
+{
+    execTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+    svc.stats.updateExecTime(execTimeNs);
+    svc.stats.updateCpuTime(cpuTimeNs, execTimeNs);
+    svc.stats.updateResponseTime(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     endTime - jobRelease).count());
+    svc.stats.updateBlockingTime(svc.jobBlockingNs);
+
+    // Check for deadline miss
+    bool missed = endTime > jobDeadline;
+    if (missed)
+    {
+        svc.stats.missDeadline();
+    }
+    return missed;
+}
+
+void* Sequencer::workerEntry(void* arg)
+{
+    Service* svc = static_cast<Service*>(arg);
+    svc->owner->runWorker(*svc);
+    return nullptr;
+}
+
+int Sequencer::createWorker(Service& svc, bool realTime, bool pinned, const char*& step)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    step = "stack size";
+    int err = pthread_attr_setstacksize(&attr, memoryConfig.workerStackSize);
+
+    // Policy and priority are applied by pthread_create(), before the
+    // thread runs a single instruction
+    if (err == 0 && realTime)
+    {
+        step = "SCHED_FIFO priority";
+        sched_param param{};
+        param.sched_priority = svc.priority;
+        err = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        if (err == 0) err = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        if (err == 0) err = pthread_attr_setschedparam(&attr, &param);
+    }
+    if (err == 0 && pinned)
+    {
+        step = "CPU affinity";
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(svc.cpuAffinity, &cpuset);
+        err = pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+    }
+    if (err == 0)
+    {
+        step = "pthread_create";
+        err = pthread_create(&svc.worker, &attr, workerEntry, &svc);
+    }
+
+    pthread_attr_destroy(&attr);
+    return err;
+}
+
+bool Sequencer::startWorkers()
+{
+    startLatch = std::make_unique<std::latch>(static_cast<std::ptrdiff_t>(services.size()));
+
+    bool ok = true;
+    for (auto &svc : services)
+    {
+        bool realTime = svc->priority > 0;
+        bool pinned = svc->cpuAffinity >= 0;
+
+        const char* step = "";
+        int err = createWorker(*svc, realTime, pinned, step);
+
+        // Not strict: give up the affinity first, then the priority
+        if (err != 0 && !strictRealTime && pinned)
+        {
+            std::cerr << svc->name << ": worker " << step << " failed: " << strerror(err)
+                      << " -> starting it unpinned\n";
+            err = createWorker(*svc, realTime, false, step);
+        }
+        if (err != 0 && !strictRealTime && realTime)
+        {
+            std::cerr << svc->name << ": worker " << step << " failed: " << strerror(err)
+                      << " -> starting it as a normal thread\n";
+            err = createWorker(*svc, false, false, step);
+        }
+        if (err != 0)
+        {
+            std::cerr << svc->name << ": worker " << step << " failed: " << strerror(err) << "\n";
+            startLatch->count_down();  // nobody will
+            ok = false;
+            continue;
+        }
+        svc->workerStarted = true;
+    }
+
+    // Every worker is configured, prefaulted and parked before the first release
+    startLatch->wait();
+
+    for (auto &svc : services)
+    {
+        if (!svc->workerStarted) continue;
+
+        bool realTimeOk = svc->priority <= 0
+                          || (svc->runningPolicy == SCHED_FIFO && svc->runningPriority == svc->priority);
+        bool pinnedOk = svc->cpuAffinity < 0 || svc->runningPinned;
+        if (!realTimeOk)
+        {
+            std::cerr << svc->name << ": worker is not SCHED_FIFO " << svc->priority
+                      << " (policy " << svc->runningPolicy << ", priority " << svc->runningPriority << ")\n";
+        }
+        if (!pinnedOk)
+        {
+            std::cerr << svc->name << ": worker is not pinned to CPU " << svc->cpuAffinity << "\n";
+        }
+        if (strictRealTime && !(realTimeOk && pinnedOk)) ok = false;
+    }
+
+    // Say once how the counters are read, and again only for a service
+    // whose worker ended up with different ones
+    const PerfStats* reported = nullptr;
+    for (auto &svc : services)
+    {
+        const PerfStats* perf = svc->perf.get();
+        if (!perf || !svc->workerStarted) continue;
+        if (reported && std::equal(std::begin(perf->source), std::end(perf->source), std::begin(reported->source)))
+        {
+            continue;
+        }
+        reported = perf;
+
+        std::cerr << svc->name << ": perf counters:";
+        for (int i = 0; i < PERF_COUNTERS; i++)
+        {
+            static const char* sourceNames[] = {"unavailable", "rdpmc", "read", "getrusage"};
+            std::cerr << " " << perfCounterNames[i] << "=" << sourceNames[static_cast<int>(perf->source[i])];
+        }
+        if (perf->hardwareError) std::cerr << " (hardware: " << strerror(perf->hardwareError) << ")";
+        if (perf->softwareError) std::cerr << " (software: " << strerror(perf->softwareError) << ")";
+        std::cerr << "\n";
+    }
+    return ok;
+}
+
+void Sequencer::prepareMemory()
+{
+    if (memoryConfig.heapPrefaultBytes > 0)
+    {
+        // Keep freed memory in the process (no trimming, no mmap'd chunks),
+        // so the pages prefaulted below stay ours
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+    }
+
+    if (memoryConfig.lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+        std::cerr << "mlockall error: " << strerror(errno)
+                  << " (check RLIMIT_MEMLOCK / CAP_IPC_LOCK)\n";
+    }
+
+    if (memoryConfig.heapPrefaultBytes > 0)
+    {
+        char* heap = static_cast<char*>(malloc(memoryConfig.heapPrefaultBytes));
+        if (!heap)
+        {
+            std::cerr << "heap prefault: malloc of " << memoryConfig.heapPrefaultBytes << " bytes failed\n";
+            return;
+        }
+        long pageSize = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < memoryConfig.heapPrefaultBytes; i += static_cast<size_t>(pageSize))
+        {
+            static_cast<volatile char*>(heap)[i] = 0;
+        }
+        free(heap);
+    }
+}
+
+////////////////////////////////////////////
+// Windowed statistics
+////////////////////////////////////////////
+
+void WindowAccumulator::merge(const WindowAccumulator& other)
+{
+    jobs += other.jobs;
+    deadlineMisses += other.deadlineMisses;
+    overruns += other.overruns;
+    minExecNs = std::min(minExecNs, other.minExecNs);
+    maxExecNs = std::max(maxExecNs, other.maxExecNs);
+    totalExecNs += other.totalExecNs;
+    minReleaseJitterNs = std::min(minReleaseJitterNs, other.minReleaseJitterNs);
+    maxReleaseJitterNs = std::max(maxReleaseJitterNs, other.maxReleaseJitterNs);
+    totalReleaseJitterNs += other.totalReleaseJitterNs;
+    for (int b = 0; b < RTHistogram::BUCKETS; b++)
+    {
+        execHist[b] += other.execHist[b];
+        releaseJitterHist[b] += other.releaseJitterHist[b];
+    }
+}
+
+WindowSummary WindowAccumulator::summarize(std::chrono::milliseconds length,
+                                           std::chrono::steady_clock::time_point end) const
+{
+    WindowSummary s;
+    s.length = length;
+    s.start = start;
+    s.end = end;
+    s.jobs = jobs;
+    s.deadlineMisses = deadlineMisses;
+    s.overruns = overruns;
+    if (jobs == 0) return s;
+
+    // Bucket edges can overshoot the true max
+    s.minExecNs = minExecNs;
+    s.maxExecNs = maxExecNs;
+    s.avgExecNs = double(totalExecNs) / double(jobs);
+    s.p50ExecNs = std::min(RTHistogram::percentileOf(execHist, 0.50), maxExecNs);
+    s.p90ExecNs = std::min(RTHistogram::percentileOf(execHist, 0.90), maxExecNs);
+    s.p99ExecNs = std::min(RTHistogram::percentileOf(execHist, 0.99), maxExecNs);
+    s.p999ExecNs = std::min(RTHistogram::percentileOf(execHist, 0.999), maxExecNs);
+
+    s.minReleaseJitterNs = minReleaseJitterNs;
+    s.maxReleaseJitterNs = maxReleaseJitterNs;
+    s.avgReleaseJitterNs = double(totalReleaseJitterNs) / double(jobs);
+    s.p50ReleaseJitterNs = std::min(RTHistogram::percentileOf(releaseJitterHist, 0.50), maxReleaseJitterNs);
+    s.p90ReleaseJitterNs = std::min(RTHistogram::percentileOf(releaseJitterHist, 0.90), maxReleaseJitterNs);
+    s.p99ReleaseJitterNs = std::min(RTHistogram::percentileOf(releaseJitterHist, 0.99), maxReleaseJitterNs);
+    s.p999ReleaseJitterNs = std::min(RTHistogram::percentileOf(releaseJitterHist, 0.999), maxReleaseJitterNs);
+    return s;
+}
+
+void Sequencer::setupWindows()
+{
+    for (auto &svc : services)
+    {
+        if (windowLengths.empty() || svc->windows) continue;
+        svc->windows = std::make_unique<WindowedStats>();
+        svc->windows->lengths = windowLengths;
+        svc->windows->open.resize(windowLengths.size());
+        svc->windows->closed.resize(windowLengths.size());
+    }
+}
+
+bool Sequencer::startWindowThread()
+{
+    if (windowThreadStarted) return true;
+    windowStop = false;
+
+    int err = createNormalThread(windowThread, windowEntry, this);
+    if (err != 0)
+    {
+        std::cerr << "windows: pthread_create failed: " << strerror(err) << "\n";
+        return false;
+    }
+    windowThreadStarted = true;
+    return true;
+}
+
+void Sequencer::stopWindowThread()
+{
+    if (!windowThreadStarted) return;
+    {
+        std::lock_guard<std::mutex> lock(windowLock);
+        windowStop = true;
+    }
+    windowWake.notify_all();
+    pthread_join(windowThread, nullptr);
+    windowThreadStarted = false;
+}
+
+void* Sequencer::windowEntry(void* arg)
+{
+    static_cast<Sequencer*>(arg)->runWindows();
+    return nullptr;
+}
+
+void Sequencer::runWindows()
+{
+    auto base = windowLengths.front();
+    auto boundary = std::chrono::steady_clock::now();
+    for (auto &svc : services)
+    {
+        for (auto &acc : svc->windows->open) acc.start = boundary;
+    }
+
+    unsigned long long tick = 0;
+    std::unique_lock<std::mutex> lock(windowLock);
+    while (true)
+    {
+        boundary += base;
+        if (windowWake.wait_until(lock, boundary, [this] { return windowStop; })) return;
+
+        // Late (suspended, overloaded): close one window now and realign
+        auto now = std::chrono::steady_clock::now();
+        if (now - boundary > base) boundary = now;
+
+        tick++;
+        for (auto &svc : services)
+        {
+            rotateWindows(*svc, boundary, tick);
+        }
+    }
+}
+
+void Sequencer::rotateWindows(Service& svc, std::chrono::steady_clock::time_point now, unsigned long long tick)
+{
+    WindowedStats& w = *svc.windows;
+
+    // Flip, then wait out a record() that started on the old bank. It is a
+    // handful of stores, unless a worker preempted mid-record (then we wait
+    // for it to run again, which is the point of being the low priority side).
+    int old = w.active.load(std::memory_order_relaxed);
+    w.active.store(1 - old, std::memory_order_seq_cst);
+    WindowBank& bank = w.banks[old];
+    while (bank.writing.load(std::memory_order_seq_cst))
+    {
+        sched_yield();
+    }
+
+    // Drain the old bank into a base window
+    WindowAccumulator closed;
+    closed.start = w.open.front().start;
+    closed.jobs = bank.count.exchange(0, std::memory_order_relaxed);
+    closed.minExecNs = bank.minExecNs.exchange(std::numeric_limits<long long>::max(), std::memory_order_relaxed);
+    closed.maxExecNs = bank.maxExecNs.exchange(0, std::memory_order_relaxed);
+    closed.totalExecNs = bank.totalExecNs.exchange(0, std::memory_order_relaxed);
+    closed.minReleaseJitterNs = bank.minReleaseJitterNs.exchange(std::numeric_limits<long long>::max(), std::memory_order_relaxed);
+    closed.maxReleaseJitterNs = bank.maxReleaseJitterNs.exchange(0, std::memory_order_relaxed);
+    closed.totalReleaseJitterNs = bank.totalReleaseJitterNs.exchange(0, std::memory_order_relaxed);
+    for (int b = 0; b < RTHistogram::BUCKETS; b++)
+    {
+        closed.execHist[b] = bank.execHist.counts[b].exchange(0, std::memory_order_relaxed);
+        closed.releaseJitterHist[b] = bank.releaseJitterHist.counts[b].exchange(0, std::memory_order_relaxed);
+    }
+
+    // Misses and overruns come from the lifetime counters
+    long long misses = svc.stats.deadlineMissCount.load(std::memory_order_relaxed);
+    long long overruns = svc.stats.overrunCount.load(std::memory_order_relaxed);
+    closed.deadlineMisses = misses - w.seenMisses;
+    closed.overruns = overruns - w.seenOverruns;
+    w.seenMisses = misses;
+    w.seenOverruns = overruns;
+
+    // Fold into every length; publish the ones that end on this boundary
+    for (size_t i = 0; i < w.lengths.size(); i++)
+    {
+        w.open[i].merge(closed);
+        unsigned long long multiple = static_cast<unsigned long long>(w.lengths[i] / w.lengths.front());
+        if (tick % multiple != 0) continue;
+
+        WindowSummary summary = w.open[i].summarize(w.lengths[i], now);
+        {
+            std::lock_guard<std::mutex> lock(w.closedLock);
+            w.closed[i] = summary;
+        }
+        w.open[i] = WindowAccumulator{};
+        w.open[i].start = now;
+    }
+}
+
+////////////////////////////////////////////
+// Deadline-miss forensics
+////////////////////////////////////////////
+
+MissQueue::MissQueue()
+{
+    for (size_t i = 0; i < MISS_QUEUE_SIZE; i++)
+    {
+        cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool MissQueue::push(const MissRecord& rec)
+{
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Cell& cell = cells[pos & (MISS_QUEUE_SIZE - 1)];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        long long diff = static_cast<long long>(seq) - static_cast<long long>(pos);
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.rec = rec;
+                cell.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Full: the logger is behind
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool MissQueue::pop(MissRecord& rec)
+{
+    // Single consumer: no CAS needed on dequeuePos
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell& cell = cells[pos & (MISS_QUEUE_SIZE - 1)];
+    size_t seq = cell.seq.load(std::memory_order_acquire);
+    if (static_cast<long long>(seq) - static_cast<long long>(pos + 1) < 0) return false;
+
+    rec = cell.rec;
+    cell.seq.store(pos + MISS_QUEUE_SIZE, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+JobTraceSlot* Sequencer::beginJobTrace(Service& svc)
+{
+    // Only this worker writes its ring; the head is published after the slot
+    unsigned long long head = svc.traceHead.load(std::memory_order_relaxed);
+    JobTraceSlot& slot = svc.trace[head % MISS_TRACE_DEPTH];
+    slot.endNs.store(0, std::memory_order_relaxed);
+    slot.cpu.store(sched_getcpu(), std::memory_order_relaxed);
+    slot.startNs.store(steadyNowNs(), std::memory_order_relaxed);
+    svc.traceHead.store(head + 1, std::memory_order_release);
+    return &slot;
+}
+
+void Sequencer::captureMiss(MissRecord& rec)
+{
+    // Who else ran on this CPU between our release and our end?
+    for (auto &other : services)
+    {
+        if (other.get() == rec.service) continue;
+
+        unsigned long long head = other->traceHead.load(std::memory_order_acquire);
+        unsigned long long depth = std::min<unsigned long long>(head, MISS_TRACE_DEPTH);
+        for (unsigned long long k = 1; k <= depth; k++)
+        {
+            const JobTraceSlot& slot = other->trace[(head - k) % MISS_TRACE_DEPTH];
+            long long start = slot.startNs.load(std::memory_order_relaxed);
+            long long end = slot.endNs.load(std::memory_order_relaxed);
+            int cpu = slot.cpu.load(std::memory_order_relaxed);
+
+            if (cpu != rec.cpu || start >= rec.endNs) continue;
+            if (end != 0 && end <= rec.releaseNs) break;  // older ones ended earlier still
+
+            if (rec.overlapCount == MISS_MAX_OVERLAPS)
+            {
+                rec.overlapsDropped++;
+                continue;
+            }
+            rec.overlaps[rec.overlapCount++] = {other.get(), start, end};
+        }
+    }
+
+    missQueue->push(rec);
+}
+
+bool Sequencer::startMissLogger()
+{
+    if (missThreadStarted) return true;
+
+    if (!missLogPath.empty())
+    {
+        missLog = fopen(missLogPath.c_str(), "a");
+        if (!missLog)
+        {
+            std::cerr << "forensics: open " << missLogPath << " failed: " << strerror(errno) << "\n";
+            return false;
+        }
+    }
+    else
+    {
+        missLog = stderr;
+    }
+
+    // Before the workers exist, so they only ever see it set
+    missQueue = std::make_unique<MissQueue>();
+    missStop = false;
+
+    int err = createNormalThread(missThread, missEntry, this);
+    if (err != 0)
+    {
+        std::cerr << "forensics: pthread_create failed: " << strerror(err) << "\n";
+        missQueue.reset();
+        if (missLog != stderr) fclose(missLog);
+        missLog = nullptr;
+        return false;
+    }
+    missThreadStarted = true;
+    return true;
+}
+
+void Sequencer::stopMissLogger()
+{
+    if (!missThreadStarted) return;
+    {
+        std::lock_guard<std::mutex> lock(missLock);
+        missStop = true;
+    }
+    missWake.notify_all();
+    pthread_join(missThread, nullptr);
+    missThreadStarted = false;
+
+    long long dropped = missQueue->dropped.load();
+    if (dropped > 0)
+    {
+        fprintf(missLog, "deadline miss: %lld records dropped (logger fell behind)\n", dropped);
+    }
+    if (missLog != stderr) fclose(missLog);
+    missLog = nullptr;
+}
+
+void* Sequencer::missEntry(void* arg)
+{
+    static_cast<Sequencer*>(arg)->runMissLogger();
+    return nullptr;
+}
+
+void Sequencer::runMissLogger()
+{
+    // Workers never signal us (that could cost them a futex wake); poll
+    std::unique_lock<std::mutex> lock(missLock);
+    while (true)
+    {
+        bool stop = missWake.wait_for(lock, std::chrono::milliseconds(50), [this] { return missStop; });
+
+        MissRecord rec;
+        while (missQueue->pop(rec))
+        {
+            writeMissRecord(rec);
+        }
+        fflush(missLog);
+        if (stop) return;
+    }
+}
+
+// Numbers from /proc/self/task/<tid>/sched that matter for a miss
+struct TaskSchedInfo
+{
+    long long switches{-1};
+    long long voluntarySwitches{-1};
+    long long involuntarySwitches{-1};
+    long long migrations{-1};
+};
+
+static TaskSchedInfo readTaskSched(pid_t tid)
+{
+    TaskSchedInfo info;
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/sched", static_cast<int>(tid));
+    FILE* f = fopen(path, "r");
+    if (!f) return info;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+    {
+        char key[128];
+        long long value;
+        if (sscanf(line, "%127s : %lld", key, &value) != 2) continue;
+        if (strcmp(key, "nr_switches") == 0)                  info.switches = value;
+        else if (strcmp(key, "nr_voluntary_switches") == 0)   info.voluntarySwitches = value;
+        else if (strcmp(key, "nr_involuntary_switches") == 0) info.involuntarySwitches = value;
+        else if (strcmp(key, "se.nr_migrations") == 0)        info.migrations = value;
+    }
+    fclose(f);
+    return info;
+}
+
+// Current frequency of `cpu` in kHz, or -1 if the kernel does not say
+static long long readCpuFreqKHz(int cpu)
+{
+    if (cpu < 0) return -1;
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpu);
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    long long khz = -1;
+    if (fscanf(f, "%lld", &khz) != 1) khz = -1;
+    fclose(f);
+    return khz;
+}
+
+void Sequencer::writeMissRecord(const MissRecord& rec)
+{
+    // Read now, shortly after the miss: cumulative counters and frequency
+    TaskSchedInfo sched = readTaskSched(rec.tid);
+    long long freqKHz = readCpuFreqKHz(rec.cpu);
+
+    // Times relative to the planned release, in us
+    auto rel = [&rec](long long ns) { return double(ns - rec.releaseNs) / 1e3; };
+
+    fprintf(missLog, "deadline miss: %s job=%lld cpu=%d tid=%d start=%+.1fus end=%+.1fus deadline=%+.1fus"
+                     " late=%.1fus csw(vol/invol)=%lld/%lld",
+            rec.service->name.c_str(), rec.job, rec.cpu, static_cast<int>(rec.tid), rel(rec.startNs),
+            rel(rec.endNs), rel(rec.deadlineNs), double(rec.endNs - rec.deadlineNs) / 1e3,
+            rec.voluntarySwitches, rec.involuntarySwitches);
+
+    fprintf(missLog, " same-cpu=[");
+    for (int i = 0; i < rec.overlapCount; i++)
+    {
+        const MissRecord::Overlap& o = rec.overlaps[i];
+        if (o.endNs == 0)
+        {
+            fprintf(missLog, "%s%s(%+.1fus..running)", i ? " " : "", o.service->name.c_str(), rel(o.startNs));
+        }
+        else
+        {
+            fprintf(missLog, "%s%s(%+.1fus..%+.1fus)", i ? " " : "", o.service->name.c_str(),
+                    rel(o.startNs), rel(o.endNs));
+        }
+    }
+    if (rec.overlapsDropped > 0) fprintf(missLog, " +%d more", rec.overlapsDropped);
+    fprintf(missLog, "]");
+
+    fprintf(missLog, " sched(switches=%lld vol=%lld invol=%lld migrations=%lld)",
+            sched.switches, sched.voluntarySwitches, sched.involuntarySwitches, sched.migrations);
+    if (freqKHz >= 0) fprintf(missLog, " cpufreq=%lldkHz\n", freqKHz);
+    else              fprintf(missLog, " cpufreq=n/a\n");
+}
+
+bool Sequencer::setupTelemetry()
+{
+    size_t bytes = sizeof(TelemetryHeader) + services.size() * sizeof(TelemetryService);
+
+    // A leftover segment of a dead process with our name is simply replaced
+    int fd = shm_open(telemetryName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "telemetry: shm_open " << telemetryName << " failed: " << strerror(errno) << "\n";
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) < 0)
+    {
+        std::cerr << "telemetry: ftruncate failed: " << strerror(errno) << "\n";
+        close(fd);
+        shm_unlink(telemetryName.c_str());
+        return false;
+    }
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "telemetry: mmap failed: " << strerror(errno) << "\n";
+        shm_unlink(telemetryName.c_str());
+        return false;
+    }
+
+    // Touch every page now (and mlockall() keeps them), so publishing never faults
+    memset(map, 0, bytes);
+    telemetryHeader = static_cast<TelemetryHeader*>(map);
+    telemetryBytes = bytes;
+
+    // Readers skip the segment until state says RUNNING
+    TelemetryHeader& header = *telemetryHeader;
+    header.magic = SEQ_TELEMETRY_MAGIC;
+    header.version = SEQ_TELEMETRY_VERSION;
+    header.headerSize = sizeof(TelemetryHeader);
+    header.serviceSize = sizeof(TelemetryService);
+    header.serviceCount = static_cast<uint32_t>(services.size());
+    header.ringSize = SEQ_TELEMETRY_RING;
+    header.pid = getpid();
+    header.state = TELEMETRY_STARTING;
+
+    auto* entries = reinterpret_cast<TelemetryService*>(static_cast<char*>(map) + sizeof(TelemetryHeader));
+    for (size_t i = 0; i < services.size(); i++)
+    {
+        Service& svc = *services[i];
+        TelemetryService& t = entries[i];
+        strncpy(t.name, svc.name.c_str(), SEQ_TELEMETRY_NAME - 1);
+        t.periodNs = svc.periodNs.load(std::memory_order_relaxed);
+        t.priority = svc.priority;
+        t.cpu = svc.cpuAffinity;
+        svc.telemetry = &t;
+    }
+    return true;
+}
+
+void Sequencer::teardownTelemetry()
+{
+    if (!telemetryHeader) return;
+
+    for (auto &svc : services)
+    {
+        svc->telemetry = nullptr;
+    }
+    munmap(telemetryHeader, telemetryBytes);
+    shm_unlink(telemetryName.c_str());
+    telemetryHeader = nullptr;
+}
+
+void Sequencer::publishTelemetry(Service& svc, std::chrono::steady_clock::time_point jobRelease,
+                                 long long jitterNs, long long execNs, bool missed)
+{
+    TelemetryService& t = *svc.telemetry;
+    const RTStatistics& st = svc.stats;
+    long long releaseNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              jobRelease.time_since_epoch()).count();
+
+    // Only this worker writes the entry
+    uint64_t head = t.ringHead;
+    TelemetryRelease& slot = t.ring[head % SEQ_TELEMETRY_RING];
+
+    telemetryWriteBegin(t);
+    telemetryStore(t.periodNs, svc.periodNs.load(std::memory_order_relaxed));
+    telemetryStore(t.jobs, st.count.load(std::memory_order_relaxed));
+    telemetryStore(t.deadlineMisses, st.deadlineMissCount.load(std::memory_order_relaxed));
+    telemetryStore(t.overruns, st.overrunCount.load(std::memory_order_relaxed));
+    telemetryStore(t.execMinNs, st.minExecNs.load(std::memory_order_relaxed));
+    telemetryStore(t.execMaxNs, st.maxExecNs.load(std::memory_order_relaxed));
+    telemetryStore(t.execTotalNs, st.totalExecNs.load(std::memory_order_relaxed));
+    telemetryStore(t.releaseJitterMinNs, st.minReleaseJitterNs.load(std::memory_order_relaxed));
+    telemetryStore(t.releaseJitterMaxNs, st.maxReleaseJitterNs.load(std::memory_order_relaxed));
+    telemetryStore(t.releaseJitterTotalNs, st.totalReleaseJitterNs.load(std::memory_order_relaxed));
+    telemetryStore(t.updatedNs, steadyNowNs());
+    telemetryStore(slot.releaseNs, releaseNs);
+    telemetryStore(slot.jitterNs, jitterNs);
+    telemetryStore(slot.execNs, execNs);
+    telemetryStore(slot.flags, missed ? TELEMETRY_RELEASE_MISSED : 0);
+    std::atomic_ref<uint64_t>(t.ringHead).store(head + 1, std::memory_order_relaxed);
+    telemetryWriteEnd(t);
+}
+
+void Sequencer::setupTimer(std::chrono::microseconds masterInterval, std::chrono::steady_clock::time_point first)
+{
+    // We use SIGALRM for the periodic timer
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = Sequencer::alarmHandler;
+    sigaction(SIGALRM, &sa, nullptr);
+
+    // Create POSIX timer
+    sigevent sev{};
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo = SIGALRM;
+
+    // CLOCK_MONOTONIC is steady_clock, the clock of the release table: no
+    // drift against it, and no jumps when the wall clock is set
+    if (timer_create(CLOCK_MONOTONIC, &sev, &timerId) < 0)
+    {
+        std::cerr << "timer_create error: " << strerror(errno) << "\n";
+        return;
+    }
+
+    // Start periodic timer, first expiry at the first release (absolute)
+    long long firstNs = std::chrono::duration_cast<std::chrono::nanoseconds>(first.time_since_epoch()).count();
+    itimerspec its{};
+    its.it_value.tv_sec = firstNs / 1000000000;
+    its.it_value.tv_nsec = firstNs % 1000000000;
+    // interval for periodic
+    its.it_interval.tv_sec = masterInterval.count() / 1000000;
+    its.it_interval.tv_nsec = (masterInterval.count() % 1000000) * 1000;
+
+    // Expiry k is due at timerArmedNs + k * timerIntervalNs (stage probe)
+    timerIntervalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(masterInterval).count();
+    timerArmedNs = firstNs - timerIntervalNs;
+
+    if (timer_settime(timerId, TIMER_ABSTIME, &its, nullptr) < 0)
+    {
+        std::cerr << "timer_settime error: " << strerror(errno) << "\n";
+    }
+}
+
+void Sequencer::teardownTimer()
+{
+    if (timerId != nullptr)
+    {
+        timer_delete(timerId);
+        timerId = nullptr;
+    }
+}
+
+void Sequencer::alarmHandler(int signo)
+{
+    if (signo == SIGALRM && gInstance && gInstance->running && !gInstance->virtualClock)
+    {
+        if (gInstance->stageProbe) gInstance->handlerEntryNs = steadyNowNs();
+        gInstance->onAlarm();
+    }
+}
+
+void Sequencer::sigintHandler(int signo)
+{
+    if (signo == SIGINT && gInstance)
+    {
+        std::cout << "\nSIGINT received -> Stopping services...\n";
+        gInstance->stopServices();
+        // Print final stats
+        gInstance->printStatistics();
+        if (gInstance->shutdownHook) gInstance->shutdownHook();
+        // Then exit
+        std::_Exit(EXIT_SUCCESS);
+    }
+}
+
+void Sequencer::applyModePriority(Service& svc)
+{
+    svc.appliedModePriority = svc.modePriority.load(std::memory_order_relaxed);
+
+    // Only a SCHED_FIFO worker has a priority to change
+    if (svc.runningPolicy != SCHED_FIFO) return;
+    sched_param param{};
+    param.sched_priority = svc.appliedModePriority;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) svc.runningPriority = param.sched_priority;
+}
+
+void Sequencer::runJob(Service& svc)
+{
+#ifdef SEQUENCER_ALLOC_GUARD
+    rtAllocCounter = &svc.stats.hotPathAllocs;
+#endif
+    currentJob = &svc;
+    svc.jobBlockingNs = 0;
+
+    if (svc.arena)
+    {
+        // Drop whatever the previous job allocated
+        svc.arena->release();
+        try
+        {
+            svc.arenaServiceFunc(*svc.arena);
+        }
+        catch (const std::bad_alloc&)
+        {
+            svc.stats.arenaOverflows++;
+        }
+    }
+    else
+    {
+        svc.serviceFunc();
+    }
+
+    currentJob = nullptr;
+#ifdef SEQUENCER_ALLOC_GUARD
+    rtAllocCounter = nullptr;
+#endif
+}
+
+bool Sequencer::waitForRelease(Service& svc)
+{
+    if (!svc.selfTimed)
+    {
+        // Block: this is the release from onAlarm(). Self-timed: this is the
+        // start gate, opened once by startServices() after firstRelease is set.
+        // The strategy is read after acquire(): setWaitStrategy() may have run
+        // while we were already parked here.
+        svc.releaseSem.acquire();
+        if (!svc.keepRunning) return false;
+        if (svc.waitStrategy == WaitStrategy::Block) return true;
+
+        // Self-timed from now on: the worker keeps its own release timeline
+        svc.selfTimed = true;
+        svc.jobRelease = svc.firstRelease;
+    }
+    else
+    {
+        std::chrono::nanoseconds period(svc.selfTimedPeriodNs);
+        svc.jobRelease += period;
+        // If we overran, release once now and skip the releases already past
+        // (Queue), or skip them all and wait for the next one (Skip)
+        auto now = std::chrono::steady_clock::now();
+        if (svc.jobRelease < now)
+        {
+            svc.stats.overrunCount.fetch_add(1, std::memory_order_relaxed);
+            if (svc.overrunPolicy == OverrunPolicy::Skip) now += period;
+        }
+        while (svc.jobRelease + period <= now)
+        {
+            svc.jobRelease += period;
+        }
+    }
+
+    // A period change (setPeriod()) starts with this job
+    svc.selfTimedPeriodNs = svc.periodNs.load(std::memory_order_relaxed);
+    svc.jobDeadline = svc.jobRelease + svc.relativeDeadline(svc.selfTimedPeriodNs);
+
+    if (svc.waitStrategy == WaitStrategy::SelfTimed)
+    {
+        return sleepUntil(svc, svc.jobRelease);
+    }
+    return spinUntil(svc, svc.jobRelease);
+}
+
+bool Sequencer::sleepUntil(Service& svc, std::chrono::steady_clock::time_point target)
+{
+    // steady_clock is CLOCK_MONOTONIC on Linux, so its epoch is the same
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(target.time_since_epoch());
+    timespec ts;
+    ts.tv_sec = sinceEpoch.count() / 1000000000LL;
+    ts.tv_nsec = sinceEpoch.count() % 1000000000LL;
+
+    // SIGALRM may land on this thread; just go back to sleep
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+        ; // loop
+
+    return svc.keepRunning;
+}
+
+bool Sequencer::spinUntil(Service& svc, std::chrono::steady_clock::time_point target)
+{
+    // Far from the release: block. stopServices() releases the semaphore,
+    // which ends the wait early.
+    if (target - std::chrono::steady_clock::now() > svc.spin.blockMargin)
+    {
+        if (svc.releaseSem.try_acquire_until(target - svc.spin.blockMargin))
+        {
+            return svc.keepRunning;
+        }
+    }
+
+    // Adaptive spin: give the core away while still far, pause when close
+    while (true)
+    {
+        auto left = target - std::chrono::steady_clock::now();
+        if (left <= svc.spin.busyWindow) break;
+        if (!svc.keepRunning) return false;
+
+        if (left > svc.spin.yieldAbove)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            cpuRelax();
+        }
+    }
+
+    // Last stretch: busy-wait to the exact instant
+    while (std::chrono::steady_clock::now() < target)
+        ; // spin
+
+    return svc.keepRunning;
+}
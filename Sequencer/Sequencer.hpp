@@ -0,0 +1,1257 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <csignal>
+#include <semaphore>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <latch>
+#include <memory_resource>
+#include <new>
+
+// For setting CPU affinity & priority
+#include <pthread.h>
+#include <sched.h>
+
+////////////////////////////////////////////
+// Lock-free latency histogram
+////////////////////////////////////////////
+// Log-linear buckets: values below 2^SUB_BITS ns get a bucket each, above
+// that every power of two is split into 2^SUB_BITS buckets (~12% wide).
+// The worker is the only writer (one relaxed add per sample); readers copy
+// the counters whenever they like and never hold the worker up.
+struct RTHistogram
+{
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS) * SUB;
+
+    std::atomic<long long> counts[BUCKETS] = {};
+
+    static int bucketOf(long long ns)
+    {
+        if (ns < SUB) return ns < 0 ? 0 : static_cast<int>(ns);
+        int msb = 63 - __builtin_clzll(static_cast<unsigned long long>(ns));
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB + static_cast<int>((ns >> shift) & (SUB - 1));
+    }
+
+    // Largest value that lands in bucket `b`
+    static long long bucketUpperNs(int b)
+    {
+        if (b < SUB) return b;
+        int shift = b / SUB - 1;
+        return ((static_cast<long long>(SUB + b % SUB) + 1) << shift) - 1;
+    }
+
+    void add(long long ns)
+    {
+        counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Value at quantile q (0..1) of everything recorded so far, as the upper
+    // edge of its bucket; 0 if empty
+    long long percentile(double q) const
+    {
+        long long snapshot[BUCKETS];
+        for (int b = 0; b < BUCKETS; b++)
+        {
+            snapshot[b] = counts[b].load(std::memory_order_relaxed);
+        }
+        return percentileOf(snapshot, q);
+    }
+
+    // Same, over a plain copy of the counters
+    static long long percentileOf(const long long (&snapshot)[BUCKETS], double q)
+    {
+        long long total = 0;
+        for (int b = 0; b < BUCKETS; b++) total += snapshot[b];
+        if (total == 0) return 0;
+
+        long long rank = static_cast<long long>(q * double(total) + 0.5);
+        if (rank < 1) rank = 1;
+        long long seen = 0;
+        for (int b = 0; b < BUCKETS; b++)
+        {
+            seen += snapshot[b];
+            if (seen >= rank) return bucketUpperNs(b);
+        }
+        return bucketUpperNs(BUCKETS - 1);
+    }
+};
+
+////////////////////////////////////////////
+// Real-Time Statistics
+//////////////////////////////////////////
+struct RTStatistics
+{
+    // Execution time stats
+    std::atomic<long long> minExecNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxExecNs{0};
+    std::atomic<long long> totalExecNs{0};
+    std::atomic<long long> count{0};
+
+    // Release jitter stats
+    std::atomic<long long> minReleaseJitterNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxReleaseJitterNs{0};
+    std::atomic<long long> totalReleaseJitterNs{0};
+    std::atomic<long long> releaseCount{0};
+
+    // execution jitter stats (delta b/w consecutive execution times)
+    std::atomic<long long> minExecJitterNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxExecJitterNs{0};
+    std::atomic<long long> totalExecJitterNs{0};
+    std::atomic<long long> execJitterCount{0};
+
+    long long previousExecNs{0};
+
+    // The exec time above is wall clock (CLOCK_MONOTONIC), so it includes
+    // time the job spent preempted. Split it: CPU time the job itself used
+    // (CLOCK_THREAD_CPUTIME_ID) and interference = wall - CPU, i.e. time
+    // lost to higher priority threads, interrupts and blocking.
+    std::atomic<long long> minCpuNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxCpuNs{0};
+    std::atomic<long long> totalCpuNs{0};
+    std::atomic<long long> minInterferenceNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxInterferenceNs{0};
+    std::atomic<long long> totalInterferenceNs{0};
+
+    // Response time: planned release to completion (release jitter + exec)
+    std::atomic<long long> minResponseNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxResponseNs{0};
+    std::atomic<long long> totalResponseNs{0};
+
+    // Blocking: time a job waited for SharedResources (Resource.hpp) held
+    // by other threads, summed per job. Part of the interference above.
+    std::atomic<long long> minBlockingNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxBlockingNs{0};
+    std::atomic<long long> totalBlockingNs{0};
+
+    // End to end, for services in a chain (Sequencer::addDependency()): the
+    // chain head's release to the completion of this job
+    std::atomic<long long> minEndToEndNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxEndToEndNs{0};
+    std::atomic<long long> totalEndToEndNs{0};
+
+    // Deadline stats
+    std::atomic<long long> deadlineMissCount{0};
+
+    // Releases that came due while the previous job was still running
+    std::atomic<long long> overrunCount{0};
+    // Of those, released into a release the worker had not picked up yet
+    // (Queue): they add no job of their own
+    std::atomic<long long> collapsedCount{0};
+
+    // Distributions, for percentiles
+    RTHistogram execHist;
+    RTHistogram releaseJitterHist;
+    RTHistogram cpuHist;
+    RTHistogram interferenceHist;
+    RTHistogram responseHist;
+    RTHistogram blockingHist;
+    RTHistogram endToEndHist;
+
+    // Page faults of the worker thread (getrusage(RUSAGE_THREAD)).
+    // startup* = before the first release (stack prefault, thread setup),
+    // the others = everything after, i.e. the release/job loop.
+    std::atomic<long long> startupMinorFaults{0};
+    std::atomic<long long> startupMajorFaults{0};
+    std::atomic<long long> minorFaults{0};
+    std::atomic<long long> majorFaults{0};
+
+    // Per-job arena ran out (the job was cut short by std::bad_alloc)
+    std::atomic<long long> arenaOverflows{0};
+
+    // Global operator new calls made by jobs (SEQUENCER_ALLOC_GUARD builds)
+    std::atomic<long long> hotPathAllocs{0};
+
+    void updateExecTime(long long execNs)
+    {
+        // min
+        auto prevMin = minExecNs.load();
+        while (execNs < prevMin && !minExecNs.compare_exchange_weak(prevMin, execNs))
+            ; // loop
+
+        // max
+        auto prevMax = maxExecNs.load();
+        while (execNs > prevMax && !maxExecNs.compare_exchange_weak(prevMax, execNs))
+            ; // loop
+
+        totalExecNs += execNs;
+        count++;
+        execHist.add(execNs);
+
+        //exec jitter calc after first execution is over
+        if (count > 1) {
+            long long execJitter = (execNs > previousExecNs) ? (execNs - previousExecNs) : (previousExecNs - execNs);
+            auto prevMinJitter = minExecJitterNs.load();
+            while (execJitter < prevMinJitter && !minExecJitterNs.compare_exchange_weak(prevMinJitter, execJitter))
+                ;
+            auto prevMaxJitter = maxExecJitterNs.load();
+            while (execJitter > prevMaxJitter && !maxExecJitterNs.compare_exchange_weak(prevMaxJitter, execJitter))
+                ;
+            totalExecJitterNs += execJitter;
+            execJitterCount++;
+        }
+        previousExecNs = execNs;
+    }
+
+    void updateReleaseJitter(long long jitterNs)
+    {
+        if (jitterNs < 0) return; // handle negative weirdness
+
+        auto prevMin = minReleaseJitterNs.load();
+        while (jitterNs < prevMin && !minReleaseJitterNs.compare_exchange_weak(prevMin, jitterNs))
+            ; // loop
+
+        auto prevMax = maxReleaseJitterNs.load();
+        while (jitterNs > prevMax && !maxReleaseJitterNs.compare_exchange_weak(prevMax, jitterNs))
+            ; // loop
+
+        totalReleaseJitterNs += jitterNs;
+        releaseCount++;
+        releaseJitterHist.add(jitterNs);
+    }
+
+    // Per job, after updateExecTime(); the averages divide by `count`
+    void updateCpuTime(long long cpuNs, long long execNs)
+    {
+        long long interferenceNs = execNs > cpuNs ? execNs - cpuNs : 0;
+        updateRange(minCpuNs, maxCpuNs, totalCpuNs, cpuHist, cpuNs);
+        updateRange(minInterferenceNs, maxInterferenceNs, totalInterferenceNs, interferenceHist, interferenceNs);
+    }
+
+    void updateResponseTime(long long responseNs)
+    {
+        updateRange(minResponseNs, maxResponseNs, totalResponseNs, responseHist, responseNs < 0 ? 0 : responseNs);
+    }
+
+    void updateBlockingTime(long long blockingNs)
+    {
+        updateRange(minBlockingNs, maxBlockingNs, totalBlockingNs, blockingHist, blockingNs);
+    }
+
+    void updateEndToEnd(long long endToEndNs)
+    {
+        updateRange(minEndToEndNs, maxEndToEndNs, totalEndToEndNs, endToEndHist, endToEndNs < 0 ? 0 : endToEndNs);
+    }
+
+    void missDeadline() { deadlineMissCount++; }
+
+    // Helpers to get final stats
+    double avgExecNs() const
+    {
+        long long c = count.load();
+        return c == 0 ? 0.0 : double(totalExecNs.load()) / double(c);
+    }
+    double avgReleaseJitterNs() const
+    {
+        long long c = releaseCount.load();
+        return c == 0 ? 0.0 : double(totalReleaseJitterNs.load()) / double(c);
+    }
+    double avgExecJitterNs() const
+    {
+        long long c = execJitterCount.load();
+        return c == 0 ? 0.0 : double(totalExecJitterNs.load()) / double(c);
+    }
+    double avgCpuNs() const
+    {
+        long long c = count.load();
+        return c == 0 ? 0.0 : double(totalCpuNs.load()) / double(c);
+    }
+    double avgInterferenceNs() const
+    {
+        long long c = count.load();
+        return c == 0 ? 0.0 : double(totalInterferenceNs.load()) / double(c);
+    }
+    double avgResponseNs() const
+    {
+        long long c = count.load();
+        return c == 0 ? 0.0 : double(totalResponseNs.load()) / double(c);
+    }
+    double avgBlockingNs() const
+    {
+        long long c = count.load();
+        return c == 0 ? 0.0 : double(totalBlockingNs.load()) / double(c);
+    }
+    double avgEndToEndNs() const
+    {
+        long long c = count.load();
+        return c == 0 ? 0.0 : double(totalEndToEndNs.load()) / double(c);
+    }
+
+private:
+    static void updateRange(std::atomic<long long>& min, std::atomic<long long>& max, std::atomic<long long>& total,
+                            RTHistogram& hist, long long ns)
+    {
+        auto prevMin = min.load();
+        while (ns < prevMin && !min.compare_exchange_weak(prevMin, ns))
+            ; // loop
+        auto prevMax = max.load();
+        while (ns > prevMax && !max.compare_exchange_weak(prevMax, ns))
+            ; // loop
+        total += ns;
+        hist.add(ns);
+    }
+};
+
+////////////////////////////////////////////
+// Per-job performance counters
+////////////////////////////////////////////
+// With Sequencer::enablePerfCounters() each worker opens its own counters
+// (perf_event_open, this thread only) and reads them around every job:
+// hardware counters in one group (rdpmc where the kernel allows it, else
+// one read()), software counters in another. Without a PMU (most VMs) only
+// the software ones are available; without perf_event_open at all they come
+// from getrusage(). Exec jitter with high cache misses and no switches is
+// the code; with switches it is preemption.
+
+enum class PerfCounter { Cycles, Instructions, CacheMisses, ContextSwitches, PageFaults };
+constexpr int PERF_COUNTERS = 5;
+constexpr const char* perfCounterNames[PERF_COUNTERS] = {
+    "cycles", "instructions", "cache-misses", "context-switches", "page-faults"};
+
+struct PerfStats
+{
+    // Source of each counter, set by the worker before the first release
+    enum class Source { None, Rdpmc, Read, Rusage };
+    Source source[PERF_COUNTERS] = {};
+    int hardwareError{0};   // errno of the hardware group, 0 if it opened
+    int softwareError{0};   // errno of the software group, 0 if it opened
+
+    // Totals and per-job distributions
+    std::atomic<long long> total[PERF_COUNTERS] = {};
+    RTHistogram perJob[PERF_COUNTERS];
+
+    bool available(PerfCounter c) const { return source[static_cast<int>(c)] != Source::None; }
+};
+
+////////////////////////////////////////////
+// Windowed statistics
+////////////////////////////////////////////
+// RTStatistics covers the whole run, so one startup outlier owns maxExecNs
+// forever. With windows enabled (Sequencer::enableWindows()) every job is
+// also recorded into the current base window (e.g. 1 s). A low priority
+// thread closes it at each boundary, folds it into the longer windows
+// (e.g. 1 min, 1 h) and publishes the last closed window of each length.
+
+// Summary of one closed window
+struct WindowSummary
+{
+    std::chrono::milliseconds length{0};                // 0: not closed yet
+    std::chrono::steady_clock::time_point start, end;
+    long long jobs{0};
+    long long deadlineMisses{0};
+    long long overruns{0};
+
+    long long minExecNs{0}, maxExecNs{0};
+    double avgExecNs{0.0};
+    long long p50ExecNs{0}, p90ExecNs{0}, p99ExecNs{0}, p999ExecNs{0};
+
+    long long minReleaseJitterNs{0}, maxReleaseJitterNs{0};
+    double avgReleaseJitterNs{0.0};
+    long long p50ReleaseJitterNs{0}, p90ReleaseJitterNs{0}, p99ReleaseJitterNs{0}, p999ReleaseJitterNs{0};
+};
+
+// What the worker writes: one of two banks. The rotator flips `active`,
+// waits out a record() still in flight on the old bank, then reads and
+// clears it. The worker never waits.
+struct WindowBank
+{
+    std::atomic<bool> writing{false};
+    std::atomic<long long> count{0};
+    std::atomic<long long> minExecNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxExecNs{0};
+    std::atomic<long long> totalExecNs{0};
+    std::atomic<long long> minReleaseJitterNs{std::numeric_limits<long long>::max()};
+    std::atomic<long long> maxReleaseJitterNs{0};
+    std::atomic<long long> totalReleaseJitterNs{0};
+    RTHistogram execHist;
+    RTHistogram releaseJitterHist;
+};
+
+// Rotator side: a window being built up from closed base windows
+struct WindowAccumulator
+{
+    std::chrono::steady_clock::time_point start;
+    long long jobs{0};
+    long long deadlineMisses{0};
+    long long overruns{0};
+    long long minExecNs{std::numeric_limits<long long>::max()};
+    long long maxExecNs{0};
+    long long totalExecNs{0};
+    long long minReleaseJitterNs{std::numeric_limits<long long>::max()};
+    long long maxReleaseJitterNs{0};
+    long long totalReleaseJitterNs{0};
+    long long execHist[RTHistogram::BUCKETS] = {};
+    long long releaseJitterHist[RTHistogram::BUCKETS] = {};
+
+    void merge(const WindowAccumulator& other);
+    WindowSummary summarize(std::chrono::milliseconds length, std::chrono::steady_clock::time_point end) const;
+};
+
+struct WindowedStats
+{
+    // ---- Worker ----
+    WindowBank banks[2];
+    std::atomic<int> active{0};
+
+    void record(long long execNs, long long releaseJitterNs)
+    {
+        // Announce the write, then make sure the bank is still the active
+        // one (pairs with the rotator's flip-then-check)
+        int b = active.load(std::memory_order_seq_cst);
+        banks[b].writing.store(true, std::memory_order_seq_cst);
+        while (active.load(std::memory_order_seq_cst) != b)
+        {
+            banks[b].writing.store(false, std::memory_order_release);
+            b = active.load(std::memory_order_seq_cst);
+            banks[b].writing.store(true, std::memory_order_seq_cst);
+        }
+
+        // Only writer of this bank: no CAS needed for min / max
+        WindowBank& bank = banks[b];
+        bank.count.fetch_add(1, std::memory_order_relaxed);
+        if (execNs < bank.minExecNs.load(std::memory_order_relaxed)) bank.minExecNs.store(execNs, std::memory_order_relaxed);
+        if (execNs > bank.maxExecNs.load(std::memory_order_relaxed)) bank.maxExecNs.store(execNs, std::memory_order_relaxed);
+        bank.totalExecNs.fetch_add(execNs, std::memory_order_relaxed);
+        if (releaseJitterNs < bank.minReleaseJitterNs.load(std::memory_order_relaxed)) bank.minReleaseJitterNs.store(releaseJitterNs, std::memory_order_relaxed);
+        if (releaseJitterNs > bank.maxReleaseJitterNs.load(std::memory_order_relaxed)) bank.maxReleaseJitterNs.store(releaseJitterNs, std::memory_order_relaxed);
+        bank.totalReleaseJitterNs.fetch_add(releaseJitterNs, std::memory_order_relaxed);
+        bank.execHist.add(execNs);
+        bank.releaseJitterHist.add(releaseJitterNs);
+
+        bank.writing.store(false, std::memory_order_release);
+    }
+
+    // ---- Rotator ----
+    std::vector<std::chrono::milliseconds> lengths;  // [0] is the base window
+    std::vector<WindowAccumulator> open;              // per length
+    long long seenMisses{0};
+    long long seenOverruns{0};
+
+    // ---- Readers ----
+    mutable std::mutex closedLock;
+    std::vector<WindowSummary> closed;                // last closed, per length
+
+    // Last closed window of lengths[index]; false if none closed yet
+    bool last(size_t index, WindowSummary& out) const
+    {
+        std::lock_guard<std::mutex> lock(closedLock);
+        if (index >= closed.size() || closed[index].length.count() == 0) return false;
+        out = closed[index];
+        return true;
+    }
+};
+
+////////////////////////////////////////////
+// Release path timestamps (steady_clock ns)
+////////////////////////////////////////////
+// One release as it travels timer -> signal handler -> onAlarm() ->
+// releaseSem.release() -> worker acquire() -> serviceFunc(). Only collected
+// while a stage probe is installed (see Sequencer::setStageProbe()).
+struct ReleaseStages
+{
+    long long timerExpiryNs{0};  // when the timer was due to fire
+    long long handlerNs{0};      // alarmHandler() entered
+    long long onAlarmNs{0};      // onAlarm() entered
+    long long releaseNs{0};      // just before releaseSem.release()
+    long long wakeNs{0};         // acquire() returned in the worker
+    long long startNs{0};        // serviceFunc() about to run
+};
+
+////////////////////////////////////////////
+// Memory configuration
+////////////////////////////////////////////
+// Applied by the Sequencer so the release/job loop never page faults:
+// worker stacks get an explicit size and are touched up front, the heap is
+// prefaulted and kept, and everything is locked with mlockall().
+struct MemoryConfig
+{
+    bool lockMemory{true};                  // mlockall(MCL_CURRENT | MCL_FUTURE) in startServices()
+    size_t workerStackSize{256 * 1024};     // stack of each worker thread
+    size_t stackPrefaultBytes{64 * 1024};   // touched by each worker before its first release
+    size_t heapPrefaultBytes{1024 * 1024};  // malloc'd, touched and handed back to (kept by) malloc
+};
+
+////////////////////////////////////////////
+// Release wait strategies
+////////////////////////////////////////////
+// Block:          the worker sleeps in releaseSem until onAlarm() releases it.
+// SpinThenBlock:  the worker times its own releases (onAlarm() skips it).
+//                 Far from the release it blocks, then spins (yield while
+//                 still far, pause when close) and finally busy-waits to the
+//                 exact instant. Burns the core; meant for services pinned to
+//                 an isolated CPU.
+// SelfTimed:      the worker times its own releases and sleeps to each one
+//                 with clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME). No
+//                 dispatcher hop, no semaphore per job. Stopping may take up
+//                 to one period (the sleep is not interrupted).
+enum class WaitStrategy
+{
+    Block,
+    SpinThenBlock,
+    SelfTimed,
+};
+
+////////////////////////////////////////////
+// Overrun policies
+////////////////////////////////////////////
+// What a release does when it finds the service's previous job still
+// running. Either way it is counted as an overrun.
+// Queue: the job is released and runs as soon as the previous one is done,
+//        late. The worker's mailbox holds one release: further ones collapse
+//        into it (counted in collapsedCount) and the job keeps the release
+//        time of the first.
+// Skip:  the release is dropped; the next job starts on time at the
+//        following release.
+enum class OverrunPolicy
+{
+    Queue,
+    Skip,
+};
+
+struct SpinConfig
+{
+    std::chrono::microseconds blockMargin{200};  // stop blocking this long before release
+    std::chrono::microseconds yieldAbove{50};    // sched_yield() while further out than this
+    std::chrono::microseconds busyWindow{2};     // tight busy-wait for the last stretch
+};
+
+// Spin-wait hint for the core (x86 pause / ARM yield)
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+////////////////////////////////////////////
+// Cache-line layout helpers
+////////////////////////////////////////////
+// Keeps data written by different threads (timer/dispatcher vs. workers) on
+// separate cache lines, so they don't false-share.
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+template <typename T>
+struct CacheAlignedAllocator
+{
+    using value_type = T;
+
+    CacheAlignedAllocator() = default;
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{CACHE_LINE_SIZE}));
+    }
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(p, std::align_val_t{CACHE_LINE_SIZE});
+    }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using CacheAlignedVector = std::vector<T, CacheAlignedAllocator<T>>;
+
+class Sequencer;
+struct Service;
+struct TelemetryHeader;
+struct TelemetryService;
+struct ChannelStats;
+class SharedResource;
+class ReleaseCoordinator;
+inline long long channelNowNs();  // Channel.hpp
+
+#define JOIN_MAX_PREDECESSORS 63  // bits of Service::joinState below the round bit
+
+////////////////////////////////////////////
+// Deadline-miss forensics
+////////////////////////////////////////////
+// With forensics enabled (Sequencer::enableMissForensics()) a worker that
+// misses its deadline captures a MissRecord on the spot: the job's times,
+// its context switches and which other jobs ran on the same CPU meanwhile
+// (from their trace rings). It is pushed to a lock-free queue; a SCHED_OTHER
+// logger thread adds what would cost the worker file I/O
+// (/proc/self/task/<tid>/sched, cpufreq) and writes it out.
+
+#define MISS_TRACE_DEPTH  8    // recent jobs kept per service
+#define MISS_MAX_OVERLAPS 8    // other jobs recorded per miss
+#define MISS_QUEUE_SIZE   64   // records in flight, power of two
+
+// One job in a service's trace ring. Written by its worker, read racily by
+// other workers capturing a miss: best effort, neither side ever waits.
+struct JobTraceSlot
+{
+    std::atomic<long long> startNs{0};
+    std::atomic<long long> endNs{0};    // 0: still running
+    std::atomic<int> cpu{-1};
+};
+
+struct MissRecord
+{
+    const Service* service{nullptr};
+    long long job{0};                   // job number of this service
+    int cpu{-1};
+    pid_t tid{0};
+    long long releaseNs{0};             // steady_clock
+    long long startNs{0};
+    long long endNs{0};
+    long long deadlineNs{0};
+    long long voluntarySwitches{0};     // during the job (getrusage)
+    long long involuntarySwitches{0};
+
+    // Other jobs on the same CPU between release and end
+    struct Overlap
+    {
+        const Service* service;
+        long long startNs;
+        long long endNs;                // 0: still running at capture
+    };
+    Overlap overlaps[MISS_MAX_OVERLAPS];
+    int overlapCount{0};
+    int overlapsDropped{0};
+};
+
+// Bounded MPSC queue of preallocated records (Vyukov's bounded queue):
+// workers push, the logger pops. When full the record is dropped and
+// counted; nobody waits.
+class MissQueue
+{
+public:
+    MissQueue();
+    bool push(const MissRecord& rec);
+    bool pop(MissRecord& rec);
+
+    std::atomic<long long> dropped{0};
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> seq;
+        MissRecord rec;
+    };
+    Cell cells[MISS_QUEUE_SIZE];
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos{0};
+};
+
+////////////////////////////////////////////
+// Service Configuration
+////////////////////////////////////////////
+// Grouped by who writes what: configuration (cold), the dispatcher -> worker
+// handoff, and the worker-owned state and stats, each starting on its own
+// cache line. The dispatcher's own release bookkeeping is in ReleaseTable.
+struct Service
+{
+    // ---- Configuration: set up front, read-mostly ----
+    std::function<void()> serviceFunc;
+    int priority;       // e.g. 98, 99 for RT (SCHED_FIFO), or <= 0 for a normal thread
+    int cpuAffinity;    // which CPU core to run on, or -1 for no affinity
+    std::string name; 
+    std::chrono::nanoseconds period;  // how often to release, as set up; once running, see periodNs
+    std::chrono::nanoseconds offset{0};    // first release this long after the start
+    std::chrono::nanoseconds deadline{0};  // relative to each release; 0 = the period
+    std::chrono::nanoseconds budget{0};    // worst-case CPU time per job, for admission (setExecBudget())
+    OverrunPolicy overrunPolicy{OverrunPolicy::Queue};
+    std::vector<SharedResource*> resources;  // declared with useResource()
+
+    // The priorities it runs at: its own and those of the modes listing it
+    // (see OperatingMode). Set by startServices(), for resource ceilings and
+    // the response-time analysis.
+    int highestPriority{0};
+    int lowestPriority{0};
+
+    // Chains (see addDependency()): released at the completion of its
+    // predecessors, it releases its successors at its own
+    std::vector<Service*> successors;
+    std::vector<Service*> predecessors;  // at most JOIN_MAX_PREDECESSORS
+
+    // At the period in effect for the job
+    std::chrono::nanoseconds relativeDeadline(long long periodNs) const
+    {
+        return deadline.count() > 0 ? deadline : std::chrono::nanoseconds(periodNs);
+    }
+
+    // How the worker waits for its release (see WaitStrategy)
+    WaitStrategy waitStrategy{WaitStrategy::Block};
+    SpinConfig spin;
+
+    // Optional per-job arena: a preallocated monotonic buffer, reset at the
+    // start of every job and handed to arenaServiceFunc (instead of serviceFunc).
+    // Runs out -> std::bad_alloc, never a fallback to malloc.
+    std::function<void(std::pmr::memory_resource&)> arenaServiceFunc;
+    std::unique_ptr<std::byte[]> arenaBuffer;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+
+    // Worker thread, created by startServices() with priority, affinity
+    // and stack size already in its attributes
+    Sequencer* owner{nullptr};
+    pthread_t worker{};
+    bool workerStarted{false};
+
+    // What the worker found itself running with, checked by startServices()
+    int runningPolicy{SCHED_OTHER};
+    int runningPriority{0};
+    bool runningPinned{false};
+
+    // First release, set by startServices()
+    std::chrono::steady_clock::time_point firstRelease;
+
+    // This service's entry in the shared-memory telemetry segment, if enabled
+    TelemetryService* telemetry{nullptr};
+
+    // Rolling windows, if enabled (see Sequencer::enableWindows())
+    std::unique_ptr<WindowedStats> windows;
+
+    // Per-job counters, if enabled (see Sequencer::enablePerfCounters())
+    std::unique_ptr<PerfStats> perf;
+
+    // ---- Dispatcher -> worker handoff ----
+    // Use a counting semaphore for release signals
+    alignas(CACHE_LINE_SIZE) std::counting_semaphore<1> releaseSem{0};
+    std::atomic<bool> keepRunning{true};
+
+    // The period as last set (addService(), setPeriod(), a mode switch),
+    // readable from any thread; once running the only one, `period` is not
+    // written again. Whoever times the releases (onAlarm() in its
+    // ReleaseTable, a self-timed worker in selfTimedPeriodNs) takes a change
+    // up at the next release.
+    std::atomic<long long> periodNs{0};
+
+    // The job handed to the worker by the last release. Written before
+    // releaseSem.release(), so the worker sees it after acquire().
+    // (Self-timed workers write these themselves.)
+    std::chrono::steady_clock::time_point jobRelease;
+    std::chrono::steady_clock::time_point jobDeadline;
+    ReleaseStages jobStages;
+    std::chrono::steady_clock::time_point jobChainRelease;  // the chain head's release
+
+    // A join (several predecessors) releases once every predecessor has
+    // completed a job since its last release (a predecessor completing twice
+    // in a round counts once), with the earliest head release and deadline
+    // among them. joinState bit i: predecessors[i] arrived; bit 63: the
+    // round's parity. An arrival leaves its head and deadline in its slot of
+    // the round (joinSlots[parity * n + i]) before it sets its bit; the one
+    // completing the set flips the round, so the next round's arrivals write
+    // the other half while it reads this one.
+    struct JoinSlot
+    {
+        std::atomic<long long> headNs{0};
+        std::atomic<long long> deadlineNs{0};
+    };
+    std::atomic<uint64_t> joinState{0};
+    std::unique_ptr<JoinSlot[]> joinSlots;
+
+    // The priority of the running mode (see OperatingMode), taken up by the
+    // worker before its next job
+    std::atomic<int> modePriority{0};
+
+    // Set by the worker while a job runs; a release that finds it set is an
+    // overrun
+    std::atomic<bool> jobActive{false};
+
+    // Released (by onAlarm() or a ServiceTrigger), job not yet picked up by
+    // the worker: further releases coalesce into it and leave the mailbox
+    // alone
+    std::atomic<bool> triggerPending{false};
+
+    // Virtual time: released by onAlarm(), not yet run by simulateUntil()
+    bool virtualReleased{false};
+
+    // ---- Worker-owned ----
+    // Real-time stats
+    alignas(CACHE_LINE_SIZE) RTStatistics stats;
+    bool selfTimed{false};  // worker owns jobRelease (past the start gate)
+    long long selfTimedPeriodNs{0};  // period of its own timeline, see periodNs
+    long long jobBlockingNs{0};  // of the running job, see SharedResource
+    int appliedModePriority{0};  // last modePriority the worker acted on
+    pid_t tid{0};
+
+    // Recent jobs, for other workers' miss forensics (only with forensics on)
+    JobTraceSlot trace[MISS_TRACE_DEPTH];
+    std::atomic<unsigned long long> traceHead{0};
+};
+
+////////////////////////////////////////////
+// Dispatcher release table
+////////////////////////////////////////////
+// Structure-of-arrays over the services onAlarm() releases (WaitStrategy::
+// Block), built by startServices(). onAlarm() scans these contiguous,
+// cache-aligned arrays and only touches a Service when it is due; when
+// nothing is due at all, earliestReleaseNs ends the tick after one compare.
+struct ReleaseTable
+{
+    CacheAlignedVector<long long> nextReleaseNs;  // steady_clock, ns
+    CacheAlignedVector<long long> periodNs;
+    CacheAlignedVector<Service*> service;
+    long long earliestReleaseNs{std::numeric_limits<long long>::max()};
+};
+
+////////////////////////////////////////////
+// Operating modes
+////////////////////////////////////////////
+// A mode (Sequencer::defineMode()) is a named set of timed services, each
+// with its period and priority in that mode, validated and turned into its
+// own ReleaseTable by startServices(). The workers of every mode exist from
+// the start; a switch (Sequencer::requestMode()) only points onAlarm() at
+// another table, at a hyperperiod boundary of the running mode, so every
+// tick releases from exactly one mode and a switch costs no thread setup.
+// A worker takes its new priority itself, before its first job in the mode.
+
+struct ModeService
+{
+    std::string name;
+    std::chrono::nanoseconds period{0};
+    int priority{0};  // 0: the service's own (addService())
+};
+
+struct OperatingMode
+{
+    std::string name;
+    std::vector<ModeService> services;
+
+    // Built by startServices(); table.service[i] runs at priority[i]
+    ReleaseTable table;
+    std::vector<int> priority;
+    long long hyperperiodNs{0};
+    long long startNs{0};  // its (next) activation, a boundary of the mode before
+};
+
+////////////////////////////////////////////
+// Virtual time
+////////////////////////////////////////////
+// With Sequencer::useVirtualClock() the Sequencer reads the time from a
+// VirtualClock instead of steady_clock. startServices() then creates no
+// timer and no workers; simulateUntil() plays the master ticks instead:
+// onAlarm() at each tick, then every released job, run to completion on the
+// calling thread in priority order (one CPU, non-preemptive). A job models
+// its execution time by advancing the clock.
+//
+// Same inputs, same statistics, on any machine, without RT privileges and
+// as fast as the jobs run. Windows, telemetry, miss forensics and perf
+// counters are real-time observers and stay off in this mode; exec time,
+// CPU time (= exec time), response time, jitter, deadlines and overruns are
+// all kept as usual, in virtual nanoseconds.
+class VirtualClock
+{
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    explicit VirtualClock(time_point start = time_point{}) : current(start) {}
+
+    time_point now() const { return current; }
+
+    // Move forward by `d` (e.g. from a job, to model its execution time)
+    void advance(std::chrono::nanoseconds d) { current += d; }
+
+    // Move forward to `t`; never backwards
+    void advanceTo(time_point t) { current = std::max(current, t); }
+
+private:
+    time_point current;
+};
+
+////////////////////////////////////////////
+// Triggered releases
+////////////////////////////////////////////
+// A service added with period 0 is not timed: its jobs are released through
+// a ServiceTrigger (Sequencer::getTrigger()), typically by the job that
+// produces its input (see Channel.hpp). The trigger time is the job's
+// release; its deadline is the service's deadline after that
+// (setReleaseTiming(), none if 0). A trigger that finds a release not yet
+// picked up coalesces with it, as that job sees the input of both. One that
+// finds a job running follows the service's OverrunPolicy.
+class ServiceTrigger
+{
+public:
+    ServiceTrigger() = default;
+
+    explicit operator bool() const { return svc != nullptr; }
+
+    // Lock-free, from any thread (RT jobs included); no allocation, no
+    // syscall unless the worker sleeps. False if the release was dropped
+    // (Skip, or the Sequencer is not running).
+    bool release() const;
+
+private:
+    friend class Sequencer;
+    explicit ServiceTrigger(Service* svc) : svc(svc) {}
+
+    Service* svc{nullptr};
+};
+
+////////////////////////////////////////////
+// Sequencer Class
+////////////////////////////////////////////
+class Sequencer
+{
+public:
+    Sequencer();
+    ~Sequencer();
+
+    // Memory locking / prefault settings. Call before startServices(), which
+    // creates the workers.
+    void setMemoryConfig(const MemoryConfig& cfg);
+
+    // Adds a service. 
+    //  func = user code to run
+    //  priority = e.g. 98 or 99 (SCHED_FIFO)
+    //  cpuAffinity = e.g. 0 for CPU0, or -1 to disable
+    //  periodMs = desired period in milliseconds, 0 for a triggered service
+    //             (see ServiceTrigger)
+void addService(std::string name, std::function<void()> func, int priority, int cpuAffinity, int periodMs);
+
+    // Same, for sub-millisecond periods (e.g. 100us for a 10 kHz service)
+    void addService(std::string name, std::function<void()> func, int priority, int cpuAffinity,
+                    std::chrono::microseconds period);
+
+    // Same, with a per-job arena of `arenaBytes` for allocation-free jobs:
+    // allocate through the memory_resource (e.g. std::pmr::string) and it is
+    // all dropped when the next job starts.
+    void addService(std::string name, std::function<void(std::pmr::memory_resource&)> func,
+                    int priority, int cpuAffinity, std::chrono::microseconds period, size_t arenaBytes);
+
+    // Start all services with an underlying POSIX timer that ticks at `masterIntervalMs`
+    // and calls onAlarm() each time. onAlarm() will handle releasing services.
+    // Creates the workers first and waits until every one of them is running
+    // with its priority / affinity and has prefaulted its stack. Returns false
+    // (nothing started) if a worker could not be created, or, in strict mode,
+    // is not running as configured; failures are reported on stderr.
+    bool startServices(int masterIntervalMs);
+    bool startServices(std::chrono::microseconds masterInterval);
+
+    // Gracefully stop all services and cancel the timer
+    void stopServices();
+
+    // Called from the signal handler when SIGALRM fires
+    // This checks if it’s time to release each service
+    void onAlarm();
+
+    // Print final stats
+    void printStatistics();
+
+    // Switch the named service to another wait strategy. Call before
+    // startServices(). Returns false if there is no such service.
+    bool setWaitStrategy(const std::string& name, WaitStrategy strategy, SpinConfig spin = {});
+
+    // Release timing of the named service: first release `offset` after the
+    // start, each job's deadline `deadline` after its release (0: the
+    // period). Call before startServices(). False if there is no such service.
+    bool setReleaseTiming(const std::string& name, std::chrono::nanoseconds offset,
+                          std::chrono::nanoseconds deadline);
+
+    // What the named service's releases do while its previous job still runs
+    // (see OverrunPolicy). Call before startServices().
+    bool setOverrunPolicy(const std::string& name, OverrunPolicy policy);
+
+    // Release handle of the named triggered service (period 0). Empty if
+    // there is no such service or it is timed. Valid for the Sequencer's
+    // lifetime.
+    ServiceTrigger getTrigger(const std::string& name) const;
+
+    // Run the named service after `after`: each completed job of `after`
+    // releases it, within the same period. The named service becomes
+    // triggered (period 0, its own period is dropped); its deadline, unless
+    // set with setReleaseTiming(), is the one of the job that released it.
+    // With several predecessors (up to JOIN_MAX_PREDECESSORS) it runs once
+    // each of them completed a job since its last release, at the rate of
+    // the slowest. Chains and joins of any shape form a DAG; each member
+    // records its end-to-end latency from the chain head's release. Call
+    // before startServices(). False if either service does not exist, this
+    // would close a cycle, or the join is full.
+    bool addDependency(const std::string& name, const std::string& after);
+
+    // List this channel's counters and latencies (Channel.hpp) in
+    // printStatistics(). `stats` must outlive the Sequencer's run.
+    void watchChannel(std::string name, const ChannelStats& stats);
+
+    // Define an operating mode (see OperatingMode): the timed services it
+    // releases, each with its period and priority in it. With modes, a
+    // timed service runs only in the modes listing it. Call before
+    // startServices(), which starts in the first mode defined (or the one
+    // requested before). False (and why) if a service does not exist or is
+    // triggered, a period is not positive, or the hyperperiod overflows.
+    bool defineMode(const std::string& mode, std::vector<ModeService> services);
+
+    // Switch to `mode` at the next hyperperiod boundary of the running mode,
+    // i.e. at most one hyperperiod from now. Safe from any thread. A
+    // setPeriod() holds until the next switch. False if there is no such
+    // mode or another switch is still pending.
+    bool requestMode(const std::string& mode);
+
+    // The running mode, "" without modes
+    std::string currentMode() const;
+
+    // Declare that the named service's jobs lock `resource` (see
+    // Resource.hpp), for its ceiling and the blocking analysis. Call before
+    // startServices(); `resource` must outlive the Sequencer's run. False if
+    // there is no such service.
+    bool useResource(const std::string& name, SharedResource& resource);
+
+    // Worst-case CPU time of the named service's jobs. With a coordinator,
+    // budget / period of every pinned service is reserved on its CPU. Call
+    // before startServices(). False if there is no such service or the
+    // budget is negative.
+    bool setExecBudget(const std::string& name, std::chrono::nanoseconds budget);
+
+    // Coordinate with other Sequencer processes (see Coordinator.hpp):
+    // startServices() reserves this process's per-core utilization, failing
+    // if a core would be overcommitted, and starts the releases on the
+    // shared grid; stopServices() drops the reservation. `coordinator` must
+    // be open() and outlive the run. Ignored under a VirtualClock.
+    void useCoordinator(ReleaseCoordinator& coordinator);
+
+    // Change the named service's period, also while it runs: the next
+    // release is still planned with the old period, the job it releases and
+    // everything after use the new one. Safe from any thread. False if there
+    // is no such service, the period is not positive, or the service is
+    // triggered (period 0) and already running.
+    bool setPeriod(const std::string& name, std::chrono::nanoseconds period);
+
+    // Strict real-time startup: a worker that cannot get its SCHED_FIFO
+    // priority or CPU affinity fails startServices(). Default: report it
+    // and run that worker as a normal, unpinned thread.
+    void setStrictRealTime(bool strict);
+
+    // Run by the SIGINT handler after the final statistics, just before the
+    // process exits, e.g. to put a GPIO back into a safe state
+    void setShutdownHook(std::function<void()> hook);
+
+    // Publish every service's statistics and its recent releases into a
+    // POSIX shared memory segment (layout in Telemetry.hpp) for external
+    // monitors. Call before startServices(); an empty name means
+    // "/sequencer.<pid>". The segment is removed when the Sequencer goes.
+    void enableTelemetry(std::string shmName = "");
+
+    // Keep rolling statistics over windows of these lengths, e.g. {1s, 1min,
+    // 1h}. The shortest is the base window; the others are rounded to whole
+    // multiples of it. Call before startServices().
+    void enableWindows(std::vector<std::chrono::milliseconds> lengths);
+
+    // Last closed window of the named service; `window` indexes the lengths
+    // given to enableWindows(), shortest first. False if there is none yet.
+    bool getWindow(const std::string& name, size_t window, WindowSummary& out) const;
+
+    // Capture a forensic record of every deadline miss (see MissRecord) and
+    // append it to `logPath` (stderr if empty) from a low priority logger
+    // thread. Call before startServices().
+    void enableMissForensics(std::string logPath = "");
+
+    // Read cycles, instructions, cache misses, context switches and page
+    // faults around every job of every service (see PerfStats). Call before
+    // startServices(); what could not be opened is reported then.
+    void enablePerfCounters();
+
+    // Run on `clock` instead of steady_clock and the POSIX timer (see
+    // VirtualClock). Call before startServices(); `clock` must outlive the
+    // Sequencer's run.
+    void useVirtualClock(VirtualClock& clock);
+
+    // Virtual time only: play every master tick up to `until`, releasing
+    // and running jobs as they come due. The clock ends at `until`, or later
+    // if the last job ran past it.
+    void simulateUntil(std::chrono::steady_clock::time_point until);
+
+    // Virtual time only, for schedulers built on the release logic (see
+    // ScheduleSim): advance the clock to the next master tick and run
+    // onAlarm(), but hand each released service to `released` (highest
+    // priority first) instead of running its job. Returns the tick.
+    std::chrono::steady_clock::time_point stepVirtual(const std::function<void(Service&)>& released);
+
+    // Stats of the named service, or nullptr if there is none
+    const RTStatistics* getStatistics(const std::string& name) const;
+
+    // Calls `visit` for every service, in release (period) order once
+    // started. Safe from any thread while services run; only reads.
+    void visitServices(const std::function<void(const Service&)>& visit) const;
+
+    // Instrumentation for release path benchmarks: when set, every job's
+    // ReleaseStages are collected and passed to `probe` from the worker
+    // thread after the job completes. Set before startServices().
+    void setStageProbe(std::function<void(const Service&, const ReleaseStages&)> probe);
+
+private:
+    // We store all Service objects
+    std::vector<std::unique_ptr<Service>> services;
+
+    // For POSIX timer
+    timer_t timerId{nullptr};
+
+    // Set once release times are initialised; a SIGALRM still pending from a
+    // previous Sequencer's timer must not release anything before that
+    std::atomic<bool> running{false};
+
+    MemoryConfig memoryConfig;
+    bool strictRealTime{false};
+    std::function<void()> shutdownHook;
+
+    // Worker startup (startServices()): every worker counts down once warm
+    std::unique_ptr<std::latch> startLatch;
+    bool startWorkers();
+    int createWorker(Service& svc, bool realTime, bool pinned, const char*& step);
+    static void* workerEntry(void* arg);
+    void runWorker(Service& svc);
+
+    // Lock memory and prefault the heap (startServices())
+    void prepareMemory();
+
+    // Windowed statistics (see enableWindows()): a SCHED_OTHER thread closes
+    // the base window at each boundary
+    std::vector<std::chrono::milliseconds> windowLengths;
+    pthread_t windowThread{};
+    bool windowThreadStarted{false};
+    std::mutex windowLock;
+    std::condition_variable windowWake;
+    bool windowStop{false};
+    void setupWindows();
+    bool startWindowThread();
+    void stopWindowThread();
+    static void* windowEntry(void* arg);
+    void runWindows();
+    static void rotateWindows(Service& svc, std::chrono::steady_clock::time_point now, unsigned long long tick);
+
+    // Per-job performance counters (see enablePerfCounters())
+    bool perfCounters{false};
+
+    // Triggered releases (see ServiceTrigger) and watched channels
+    friend class ServiceTrigger;
+    // A chain release (see addDependency()) carries the head's release
+    // and its deadline; otherwise this release is the head
+    bool triggerRelease(Service& svc,
+                        std::chrono::steady_clock::time_point chainRelease = std::chrono::steady_clock::time_point::min(),
+                        std::chrono::steady_clock::time_point chainDeadline = std::chrono::steady_clock::time_point::max());
+    void finishChainJob(Service& svc, std::chrono::steady_clock::time_point chainRelease,
+                        std::chrono::steady_clock::time_point jobDeadline, std::chrono::steady_clock::time_point endTime);
+    std::vector<std::pair<std::string, const ChannelStats*>> channels;
+
+    // Shared resources (see SharedResource) and channel timestamps: the job
+    // running on this thread, and the time as its Sequencer sees it
+    // (steady_clock without a job)
+    friend class SharedResource;
+    friend long long channelNowNs();
+    static thread_local Service* currentJob;
+    static long long jobNowNs(const Service* svc);
+
+    // Virtual time (see useVirtualClock()): the clock, the next master tick,
+    // and the services in period order, which breaks priority ties
+    VirtualClock* virtualClock{nullptr};
+    std::chrono::steady_clock::time_point nextVirtualTick;
+    std::chrono::microseconds virtualInterval{0};
+    std::vector<Service*> virtualOrder;
+    std::chrono::steady_clock::time_point clockNow() const
+    {
+        return virtualClock ? virtualClock->now() : std::chrono::steady_clock::now();
+    }
+    void startVirtual(std::chrono::microseconds masterInterval);
+    void runVirtualJob(Service& svc);
+
+    // Statistics of one finished job, for a worker or a virtual job; returns
+    // true if it missed its deadline
+    static bool recordJob(Service& svc, std::chrono::steady_clock::time_point jobRelease,
+                          std::chrono::steady_clock::time_point jobDeadline,
+                          std::chrono::steady_clock::time_point startTime,
+                          std::chrono::steady_clock::time_point endTime, long long cpuTimeNs,
+                          long long& execTimeNs);
+
+    // Deadline-miss forensics (see enableMissForensics())
+    bool missForensics{false};
+    std::string missLogPath;
+    std::unique_ptr<MissQueue> missQueue;
+    FILE* missLog{nullptr};
+    pthread_t missThread{};
+    bool missThreadStarted{false};
+    std::mutex missLock;
+    std::condition_variable missWake;
+    bool missStop{false};
+    bool startMissLogger();
+    void stopMissLogger();
+    static void* missEntry(void* arg);
+    void runMissLogger();
+    void writeMissRecord(const MissRecord& rec);
+    static JobTraceSlot* beginJobTrace(Service& svc);
+    void captureMiss(MissRecord& rec);
+
+    // Shared-memory telemetry (see enableTelemetry())
+    std::string telemetryName;
+    TelemetryHeader* telemetryHeader{nullptr};
+    size_t telemetryBytes{0};
+    bool setupTelemetry();
+    void teardownTelemetry();
+    static void publishTelemetry(Service& svc, std::chrono::steady_clock::time_point jobRelease,
+                                 long long jitterNs, long long execNs, bool missed);
+
+    // Multi-process coordination (see useCoordinator())
+    ReleaseCoordinator* coordinator{nullptr};
+    std::map<int, double> cpuDemand() const;
+
+    // Release path instrumentation (see setStageProbe())
+    std::function<void(const Service&, const ReleaseStages&)> stageProbe;
+    long long timerArmedNs{0};
+    long long timerIntervalNs{0};
+    long long handlerEntryNs{0};
+
+    // This is used in the static signal handler
+    static Sequencer* gInstance;
+
+    // Setup the real-time timer for SIGALRM
+    void setupTimer(std::chrono::microseconds masterInterval, std::chrono::steady_clock::time_point first);
+
+    // Cancel the timer
+    void teardownTimer();
+
+    // Called once by signal handler
+    static void alarmHandler(int signo);
+
+    // We also want a clean shutdown on CTRL+C
+    static void sigintHandler(int signo);
+
+    // Worker side: run one job (arena reset, alloc guard)
+    static void runJob(Service& svc);
+
+    // Worker side: wait for the next release according to the service's
+    // WaitStrategy. Returns false when the service is being stopped.
+    static bool waitForRelease(Service& svc);
+    static bool spinUntil(Service& svc, std::chrono::steady_clock::time_point target);
+    static bool sleepUntil(Service& svc, std::chrono::steady_clock::time_point target);
+
+    // What onAlarm() works from (see ReleaseTable): releaseTable, or the
+    // running mode's table
+    ReleaseTable releaseTable;
+    ReleaseTable* activeTable{&releaseTable};
+    void buildReleaseTable(std::chrono::steady_clock::time_point first);
+
+    // Operating modes (see defineMode()). pendingMode is published by
+    // requestMode() and taken by onAlarm() at its startNs.
+    std::vector<std::unique_ptr<OperatingMode>> modes;
+    std::atomic<OperatingMode*> activeMode{nullptr};
+    std::atomic<OperatingMode*> pendingMode{nullptr};
+    OperatingMode* initialMode{nullptr};
+    mutable std::mutex modeLock;  // requestMode() callers
+    std::atomic<long long> modeSwitches{0};
+    void buildModeTables();
+    static void scheduleMode(OperatingMode& mode, long long startNs);
+    void enterMode(OperatingMode& mode);
+    static void applyModePriority(Service& svc);
+};
+
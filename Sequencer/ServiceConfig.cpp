@@ -0,0 +1,606 @@
+#include "ServiceConfig.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Nice value of the watching thread
+#define CONFIG_NICE 10
+
+////////////////////////////////////////////
+// Parsing
+////////////////////////////////////////////
+
+bool parseDuration(const std::string& text, std::chrono::nanoseconds& out)
+{
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    double value = strtod(begin, &end);
+    if (end == begin || !std::isfinite(value) || value < 0) return false;
+
+    std::string unit(end);
+    double scale;
+    if (unit == "ns")                    scale = 1;
+    else if (unit == "us" || unit == "") scale = 1e3;
+    else if (unit == "ms")               scale = 1e6;
+    else if (unit == "s")                scale = 1e9;
+    else return false;
+
+    // Beyond what nanoseconds hold ("1e400" is inf, caught above)
+    if (value >= double(std::numeric_limits<long long>::max()) / scale) return false;
+    out = std::chrono::nanoseconds(static_cast<long long>(value * scale + 0.5));
+    return true;
+}
+
+namespace
+{
+// One `key = value`
+struct ConfigValue
+{
+    enum class Type { String, Integer, Boolean };
+
+    Type type{Type::String};
+    std::string text;  // String
+    long long integer{0};
+    bool boolean{false};
+};
+
+std::string trim(const std::string& s)
+{
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+// Cut a `#` comment, unless it is inside a string
+std::string stripComment(const std::string& line)
+{
+    bool inString = false;
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        if (line[i] == '\\' && inString) i++;
+        else if (line[i] == '"') inString = !inString;
+        else if (line[i] == '#' && !inString) return line.substr(0, i);
+    }
+    return line;
+}
+
+bool parseValue(const std::string& text, ConfigValue& out)
+{
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"')
+    {
+        out.type = ConfigValue::Type::String;
+        out.text.clear();
+        for (size_t i = 1; i + 1 < text.size(); i++)
+        {
+            if (text[i] == '\\' && i + 2 < text.size()) i++;
+            else if (text[i] == '"') return false;
+            out.text += text[i];
+        }
+        return true;
+    }
+    if (text == "true" || text == "false")
+    {
+        out.type = ConfigValue::Type::Boolean;
+        out.boolean = text == "true";
+        return true;
+    }
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    out.integer = strtoll(begin, &end, 10);
+    out.type = ConfigValue::Type::Integer;
+    return end != begin && *end == '\0' && errno == 0;
+}
+
+// Durations are strings with a unit, or an integer number of microseconds
+bool durationOf(const ConfigValue& v, std::chrono::nanoseconds& out)
+{
+    if (v.type == ConfigValue::Type::Integer)
+    {
+        if (v.integer < 0 || v.integer > std::numeric_limits<long long>::max() / 1000) return false;
+        out = std::chrono::microseconds(v.integer);
+        return true;
+    }
+    return v.type == ConfigValue::Type::String && parseDuration(v.text, out);
+}
+
+std::string formatDuration(std::chrono::nanoseconds d)
+{
+    char buf[32];
+    long long ns = d.count();
+    if (ns != 0 && ns % 1000000000LL == 0) snprintf(buf, sizeof(buf), "%llds", ns / 1000000000LL);
+    else if (ns != 0 && ns % 1000000 == 0) snprintf(buf, sizeof(buf), "%lldms", ns / 1000000);
+    else if (ns % 1000 == 0)               snprintf(buf, sizeof(buf), "%lldus", ns / 1000);
+    else                                   snprintf(buf, sizeof(buf), "%lldns", ns);
+    return buf;
+}
+
+const char* overrunName(OverrunPolicy p)
+{
+    return p == OverrunPolicy::Skip ? "skip" : "queue";
+}
+
+const char* timerName(WaitStrategy w)
+{
+    switch (w)
+    {
+    case WaitStrategy::Block:         return "block";
+    case WaitStrategy::SpinThenBlock: return "spin";
+    case WaitStrategy::SelfTimed:     return "self-timed";
+    }
+    return "?";
+}
+} // namespace
+
+bool SequencerConfig::load(const std::string& path, SequencerConfig& out)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cerr << "config: cannot open " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+
+    auto fail = [&](int line, const std::string& why) {
+        std::cerr << path << ":" << line << ": " << why << "\n";
+        return false;
+    };
+
+    enum class Table { None, Sequencer, Service };
+    Table table = Table::None;
+    bool sawSequencer = false;
+    std::set<std::string> seen;  // keys of the current table
+    SequencerConfig config;
+
+    // Leaving a [[service]] table: it must have had its required keys
+    auto serviceComplete = [&]() {
+        if (table != Table::Service) return true;
+        const ServiceConfig& svc = config.services.back();
+        if (seen.count("after") && svc.period.count() > 0)
+        {
+            return fail(svc.line, "service " + svc.name + " runs after others, it takes no period");
+        }
+        if (seen.count("name") && (seen.count("period") || seen.count("after")) && seen.count("priority"))
+        {
+            return true;
+        }
+        return fail(svc.line, "service needs name, period and priority");
+    };
+
+    std::string raw;
+    int lineNo = 0;
+    while (std::getline(in, raw))
+    {
+        lineNo++;
+        std::string line = trim(stripComment(raw));
+        if (line.empty()) continue;
+
+        // Table headers
+        if (line == "[sequencer]")
+        {
+            if (sawSequencer) return fail(lineNo, "second [sequencer] table");
+            if (!serviceComplete()) return false;
+            sawSequencer = true;
+            table = Table::Sequencer;
+            seen.clear();
+            continue;
+        }
+        if (line == "[[service]]")
+        {
+            if (!serviceComplete()) return false;
+            config.services.emplace_back();
+            config.services.back().line = lineNo;
+            table = Table::Service;
+            seen.clear();
+            continue;
+        }
+        if (line.front() == '[') return fail(lineNo, "unknown table " + line + " ([sequencer], [[service]])");
+
+        // key = value
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) return fail(lineNo, "expected key = value");
+        std::string key = trim(line.substr(0, eq));
+        ConfigValue value;
+        if (!parseValue(trim(line.substr(eq + 1)), value)) return fail(lineNo, "bad value for " + key);
+        if (table == Table::None) return fail(lineNo, key + " outside of any table");
+        if (!seen.insert(key).second) return fail(lineNo, key + " given twice");
+
+        auto wrongType = [&](const char* expected) {
+            return fail(lineNo, key + ": expected " + expected);
+        };
+
+        if (table == Table::Sequencer)
+        {
+            if (key == "master_interval")
+            {
+                std::chrono::nanoseconds d;
+                if (!durationOf(value, d) || d < std::chrono::microseconds(1)) return wrongType("a duration of 1us or more");
+                config.masterInterval = std::chrono::duration_cast<std::chrono::microseconds>(d);
+            }
+            else if (key == "strict_real_time")
+            {
+                if (value.type != ConfigValue::Type::Boolean) return wrongType("true or false");
+                config.strictRealTime = value.boolean;
+            }
+            else return fail(lineNo, "unknown key " + key + " in [sequencer]");
+            continue;
+        }
+
+        ServiceConfig& svc = config.services.back();
+        if (key == "name")
+        {
+            if (value.type != ConfigValue::Type::String || value.text.empty()) return wrongType("a name");
+            svc.name = value.text;
+        }
+        else if (key == "period")
+        {
+            if (!durationOf(value, svc.period)) return wrongType("a duration (0: triggered)");
+        }
+        else if (key == "offset")
+        {
+            if (!durationOf(value, svc.offset)) return wrongType("a duration");
+        }
+        else if (key == "deadline")
+        {
+            if (!durationOf(value, svc.deadline)) return wrongType("a duration");
+        }
+        else if (key == "priority")
+        {
+            if (value.type != ConfigValue::Type::Integer || value.integer < -100 || value.integer > 99)
+            {
+                return wrongType("a priority (1-99 for SCHED_FIFO, <= 0 for a normal thread)");
+            }
+            svc.priority = static_cast<int>(value.integer);
+        }
+        else if (key == "cpu")
+        {
+            if (value.type != ConfigValue::Type::Integer || value.integer < -1 || value.integer >= CPU_SETSIZE)
+            {
+                return wrongType("a CPU number or -1");
+            }
+            svc.cpu = static_cast<int>(value.integer);
+        }
+        else if (key == "overrun")
+        {
+            if (value.type != ConfigValue::Type::String) return wrongType("an overrun policy");
+            if (value.text == "queue")     svc.overrun = OverrunPolicy::Queue;
+            else if (value.text == "skip") svc.overrun = OverrunPolicy::Skip;
+            else return wrongType("\"queue\" or \"skip\"");
+        }
+        else if (key == "timer")
+        {
+            if (value.type != ConfigValue::Type::String) return wrongType("a timer mode");
+            if (value.text == "block")           svc.timer = WaitStrategy::Block;
+            else if (value.text == "spin")       svc.timer = WaitStrategy::SpinThenBlock;
+            else if (value.text == "self-timed") svc.timer = WaitStrategy::SelfTimed;
+            else return wrongType("\"block\", \"spin\" or \"self-timed\"");
+        }
+        else if (key == "backend")
+        {
+            if (value.type != ConfigValue::Type::String) return wrongType("a string");
+            svc.backend = value.text;
+        }
+        else if (key == "after")
+        {
+            if (value.type != ConfigValue::Type::String) return wrongType("service names");
+            // getline() drops what follows a trailing comma
+            std::string list = trim(value.text);
+            if (!list.empty() && list.back() == ',') return wrongType("service names, separated by commas");
+            std::stringstream names(list);
+            std::string name;
+            while (std::getline(names, name, ','))
+            {
+                name = trim(name);
+                if (name.empty()) return wrongType("service names, separated by commas");
+                svc.after.push_back(name);
+            }
+            if (svc.after.empty()) return wrongType("service names");
+        }
+        else return fail(lineNo, "unknown key " + key + " in [[service]]");
+    }
+    if (!serviceComplete()) return false;
+
+    std::set<std::string> names;
+    for (const ServiceConfig& svc : config.services)
+    {
+        if (!names.insert(svc.name).second) return fail(svc.line, "service " + svc.name + " defined twice");
+    }
+    for (const ServiceConfig& svc : config.services)
+    {
+        for (const std::string& pred : svc.after)
+        {
+            if (pred == svc.name || !names.count(pred))
+            {
+                return fail(svc.line, "service " + svc.name + ": after " + pred + ": no such other service");
+            }
+        }
+    }
+
+    out = std::move(config);
+    return true;
+}
+
+////////////////////////////////////////////
+// Registry
+////////////////////////////////////////////
+
+void ServiceRegistry::add(std::string name, std::function<void()> func)
+{
+    factories[std::move(name)] = [func = std::move(func)](const ServiceConfig&) { return func; };
+}
+
+void ServiceRegistry::addFactory(std::string name, Factory factory)
+{
+    factories[std::move(name)] = std::move(factory);
+}
+
+const ServiceRegistry::Factory* ServiceRegistry::find(const std::string& name) const
+{
+    auto it = factories.find(name);
+    return it == factories.end() ? nullptr : &it->second;
+}
+
+std::string ServiceRegistry::names() const
+{
+    std::string out;
+    for (const auto& [name, factory] : factories)
+    {
+        if (!out.empty()) out += ", ";
+        out += name;
+    }
+    return out;
+}
+
+bool SequencerConfig::apply(Sequencer& seq, const ServiceRegistry& registry) const
+{
+    // Every function first, so a bad entry adds nothing
+    std::vector<std::function<void()>> funcs;
+    for (const ServiceConfig& svc : services)
+    {
+        const ServiceRegistry::Factory* factory = registry.find(svc.name);
+        if (!factory)
+        {
+            std::cerr << "config: service " << svc.name << " is not registered (registered: "
+                      << registry.names() << ")\n";
+            return false;
+        }
+        funcs.push_back((*factory)(svc));
+        if (!funcs.back())
+        {
+            std::cerr << "config: service " << svc.name << ": no function for backend '"
+                      << svc.backend << "'\n";
+            return false;
+        }
+    }
+
+    seq.setStrictRealTime(strictRealTime);
+    for (size_t i = 0; i < services.size(); i++)
+    {
+        const ServiceConfig& svc = services[i];
+        seq.addService(svc.name, std::move(funcs[i]), svc.priority, svc.cpu,
+                       std::chrono::duration_cast<std::chrono::microseconds>(svc.period));
+        if (svc.period.count() > 0) seq.setPeriod(svc.name, svc.period);  // exact, also below a microsecond
+        seq.setReleaseTiming(svc.name, svc.offset, svc.deadline);
+        seq.setOverrunPolicy(svc.name, svc.overrun);
+        seq.setWaitStrategy(svc.name, svc.timer);
+    }
+    for (const ServiceConfig& svc : services)
+    {
+        for (const std::string& pred : svc.after)
+        {
+            if (!seq.addDependency(svc.name, pred))
+            {
+                std::cerr << "config: service " << svc.name << " cannot run after " << pred << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+////////////////////////////////////////////
+// Hot reload
+////////////////////////////////////////////
+
+ConfigWatcher::ConfigWatcher(Sequencer& seq, std::string path, SequencerConfig current)
+    : seq(seq), path(std::move(path)), current(std::move(current))
+{
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+}
+
+int ConfigWatcher::reload()
+{
+    SequencerConfig next;
+    if (!SequencerConfig::load(path, next))
+    {
+        std::cerr << "config: " << path << " not reloaded, keeping the running configuration\n";
+        return -1;
+    }
+
+    auto restart = [&](const std::string& what) {
+        std::cerr << "config: " << what << " needs a restart, ignored\n";
+    };
+    if (next.masterInterval != current.masterInterval) restart("master_interval change");
+    if (next.strictRealTime != current.strictRealTime) restart("strict_real_time change");
+
+    int changed = 0;
+    for (const ServiceConfig& svc : next.services)
+    {
+        auto it = std::find_if(current.services.begin(), current.services.end(),
+                               [&](const ServiceConfig& c) { return c.name == svc.name; });
+        if (it == current.services.end())
+        {
+            restart("new service " + svc.name);
+            continue;
+        }
+
+        if (svc.period != it->period && (it->period.count() == 0 || !seq.setPeriod(svc.name, svc.period)))
+        {
+            restart(svc.name + " period " + formatDuration(it->period) + " -> " + formatDuration(svc.period));
+        }
+        else if (svc.period != it->period)
+        {
+            std::cout << "config: " << svc.name << " period " << formatDuration(it->period) << " -> "
+                      << formatDuration(svc.period) << "\n";
+            it->period = svc.period;
+            changed++;
+        }
+
+        if (svc.offset != it->offset)     restart(svc.name + " offset change");
+        if (svc.deadline != it->deadline) restart(svc.name + " deadline change");
+        if (svc.priority != it->priority) restart(svc.name + " priority change");
+        if (svc.cpu != it->cpu)           restart(svc.name + " cpu change");
+        if (svc.backend != it->backend)   restart(svc.name + " backend change");
+        if (svc.after != it->after)       restart(svc.name + " after change");
+        if (svc.overrun != it->overrun)
+        {
+            restart(svc.name + " overrun " + overrunName(it->overrun) + " -> " + overrunName(svc.overrun));
+        }
+        if (svc.timer != it->timer)
+        {
+            restart(svc.name + " timer " + timerName(it->timer) + " -> " + timerName(svc.timer));
+        }
+    }
+    for (const ServiceConfig& svc : current.services)
+    {
+        bool kept = std::any_of(next.services.begin(), next.services.end(),
+                                [&](const ServiceConfig& n) { return n.name == svc.name; });
+        if (!kept) restart("removing service " + svc.name);
+    }
+    return changed;
+}
+
+bool ConfigWatcher::start()
+{
+    if (running) return true;
+
+    // The directory, not the file: a rename over it replaces the inode
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+
+    inotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotifyFd < 0)
+    {
+        std::cerr << "config: inotify_init1 failed: " << strerror(errno) << "\n";
+        return false;
+    }
+    if (inotify_add_watch(inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        std::cerr << "config: cannot watch " << dir << ": " << strerror(errno) << "\n";
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    if (pipe2(wakePipe, O_CLOEXEC) < 0)
+    {
+        std::cerr << "config: pipe failed: " << strerror(errno) << "\n";
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    // Never RT, whatever the creating thread runs as
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    sched_param param{};
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+    int err = pthread_create(&thread, &attr, threadEntry, this);
+    pthread_attr_destroy(&attr);
+    if (err != 0)
+    {
+        std::cerr << "config: pthread_create failed: " << strerror(err) << "\n";
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void ConfigWatcher::stop()
+{
+    if (!running) return;
+
+    char byte = 0;
+    if (write(wakePipe[1], &byte, 1) < 0)
+    {
+        std::cerr << "config: wake failed: " << strerror(errno) << "\n";
+    }
+    pthread_join(thread, nullptr);
+
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    close(inotifyFd);
+    inotifyFd = -1;
+    running = false;
+}
+
+void* ConfigWatcher::threadEntry(void* arg)
+{
+    static_cast<ConfigWatcher*>(arg)->watch();
+    return nullptr;
+}
+
+void ConfigWatcher::watch()
+{
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), CONFIG_NICE);
+
+    size_t slash = path.rfind('/');
+    std::string file = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    pollfd fds[2];
+    fds[0] = {inotifyFd, POLLIN, 0};
+    fds[1] = {wakePipe[0], POLLIN, 0};
+
+    alignas(inotify_event) char buf[4096];
+    while (true)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            std::cerr << "config: poll failed: " << strerror(errno) << "\n";
+            return;
+        }
+        if (fds[1].revents) return;  // stop()
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        // One save is often several events: reload once per batch
+        bool changed = false;
+        ssize_t n;
+        while ((n = read(inotifyFd, buf, sizeof(buf))) > 0)
+        {
+            for (char* p = buf; p < buf + n;)
+            {
+                auto* ev = reinterpret_cast<inotify_event*>(p);
+                if (ev->len > 0 && file == ev->name) changed = true;
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+        if (changed) reload();
+    }
+}
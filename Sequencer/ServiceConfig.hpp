@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Sequencer.hpp"
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+////////////////////////////////////////////
+// Declarative service configuration
+////////////////////////////////////////////
+// The services of a program described in a file instead of addService()
+// calls, so their timing can be tuned on a deployed unit without
+// recompiling, and timer modes compared with the same binary. The format is
+// a small subset of TOML: `#` comments, `key = value` with strings,
+// integers and booleans, one [sequencer] table and a [[service]] table per
+// service:
+//
+//    [sequencer]
+//    master_interval = "10ms"
+//    strict_real_time = false   # see Sequencer::setStrictRealTime()
+//
+//    [[service]]
+//    name = "gpio23_toggle"     # as registered in the ServiceRegistry
+//    period = "100ms"          # 0: released by a ServiceTrigger only
+//    offset = "0ms"             # first release after the start (default 0)
+//    deadline = "50ms"          # after each release (default: the period)
+//    priority = 97
+//    cpu = 1                    # -1: not pinned (default)
+//    overrun = "queue"          # or "skip", see OverrunPolicy
+//    timer = "block"            # "spin" or "self-timed", see WaitStrategy
+//    backend = "native"         # free-form, for the service's factory
+//    after = "acquire, scale"   # run after these, see Sequencer::addDependency()
+//
+// name, period and priority are required; period is left out with after.
+// Unknown tables and keys are errors, so a typo cannot silently fall back to
+// a default.
+
+// "250ns", "40us", "10ms", "2s" (a bare number is microseconds)
+bool parseDuration(const std::string& text, std::chrono::nanoseconds& out);
+
+struct ServiceConfig
+{
+    std::string name;
+    std::chrono::nanoseconds period{0};
+    std::chrono::nanoseconds offset{0};
+    std::chrono::nanoseconds deadline{0};  // 0: the period
+    int priority{0};
+    int cpu{-1};
+    OverrunPolicy overrun{OverrunPolicy::Queue};
+    WaitStrategy timer{WaitStrategy::Block};
+    std::string backend;
+    std::vector<std::string> after;  // predecessors, see Sequencer::addDependency()
+    int line{0};  // of its [[service]] header, for messages
+};
+
+// Job functions by the name the config file uses. A factory builds the
+// function from its service's configuration, e.g. to pick the backend.
+class ServiceRegistry
+{
+public:
+    using Factory = std::function<std::function<void()>(const ServiceConfig&)>;
+
+    void add(std::string name, std::function<void()> func);
+    void addFactory(std::string name, Factory factory);
+
+    // nullptr if nothing is registered under `name`
+    const Factory* find(const std::string& name) const;
+
+    // "a, b, c", for messages
+    std::string names() const;
+
+private:
+    std::map<std::string, Factory> factories;
+};
+
+struct SequencerConfig
+{
+    std::chrono::microseconds masterInterval{std::chrono::milliseconds(10)};
+    bool strictRealTime{false};
+    std::vector<ServiceConfig> services;  // in file order
+
+    // Parse `path`. Returns false (and prints file:line: why) on any error.
+    static bool load(const std::string& path, SequencerConfig& out);
+
+    // Add every service to `seq`, with its function from `registry`, and
+    // apply the [sequencer] settings. Call before seq.startServices(), then
+    // start it with masterInterval. False (and why) if a service is not
+    // registered or its factory gives no function.
+    bool apply(Sequencer& seq, const ServiceRegistry& registry) const;
+};
+
+////////////////////////////////////////////
+// Hot reload
+////////////////////////////////////////////
+// Watches the config file from a low priority (SCHED_OTHER, niced) thread.
+// inotify watches its directory, so editors that write a new file and
+// rename it over the old one are seen too. After every change the file is
+// parsed again and period changes go to the running services through
+// Sequencer::setPeriod(). Anything else needs a restart: such changes are
+// reported and ignored, as is a file that no longer parses.
+class ConfigWatcher
+{
+public:
+    // `current` is what the Sequencer was set up with
+    ConfigWatcher(Sequencer& seq, std::string path, SequencerConfig current);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    // Start watching. Returns false (and prints why) on failure.
+    bool start();
+
+    // Stop watching
+    void stop();
+
+    // Parse the file again and apply what can be applied; what the thread
+    // does after each change. Returns the number of period changes, -1 if
+    // the file did not load.
+    int reload();
+
+private:
+    Sequencer& seq;
+    std::string path;
+    SequencerConfig current;
+
+    int inotifyFd{-1};
+    int wakePipe[2]{-1, -1};  // written by stop() to end watch()
+    pthread_t thread{};
+    bool running{false};
+
+    static void* threadEntry(void* arg);
+    void watch();
+};
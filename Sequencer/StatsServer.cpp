@@ -0,0 +1,412 @@
+#include "StatsServer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// How long a client gets to send its request / take its answer
+#define CLIENT_TIMEOUT_MS 200
+// Nice value of the serving thread
+#define STATS_NICE 10
+
+namespace
+{
+// Append printf-style to `out`
+void appendf(std::string& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+void appendf(std::string& out, const char* fmt, ...)
+{
+    char buf[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n > 0) out.append(buf, static_cast<size_t>(n) < sizeof(buf) ? static_cast<size_t>(n) : sizeof(buf) - 1);
+}
+
+// min of an untouched RTStatistics is LLONG_MAX: show 0 instead
+long long minOrZero(const std::atomic<long long>& v)
+{
+    long long x = v.load(std::memory_order_relaxed);
+    return x == std::numeric_limits<long long>::max() ? 0 : x;
+}
+
+// Service names are ours, but keep the JSON valid whatever they contain
+std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (static_cast<unsigned char>(c) < 0x20) appendf(out, "\\u%04x", c);
+        else out += c;
+    }
+    out += '"';
+    return out;
+}
+
+struct Distribution
+{
+    long long min, max, p50, p90, p99, p999;
+    double avg;
+};
+
+Distribution distribution(const std::atomic<long long>& min, const std::atomic<long long>& max,
+                          double avg, const RTHistogram& hist)
+{
+    Distribution d;
+    d.min = minOrZero(min);
+    d.max = max.load(std::memory_order_relaxed);
+    d.avg = avg;
+    // Bucket edges can overshoot the true max
+    d.p50 = std::min(hist.percentile(0.50), d.max);
+    d.p90 = std::min(hist.percentile(0.90), d.max);
+    d.p99 = std::min(hist.percentile(0.99), d.max);
+    d.p999 = std::min(hist.percentile(0.999), d.max);
+    return d;
+}
+
+Distribution execOf(const WindowSummary& w)
+{
+    return {w.minExecNs, w.maxExecNs, w.p50ExecNs, w.p90ExecNs, w.p99ExecNs, w.p999ExecNs, w.avgExecNs};
+}
+
+Distribution releaseJitterOf(const WindowSummary& w)
+{
+    return {w.minReleaseJitterNs, w.maxReleaseJitterNs, w.p50ReleaseJitterNs, w.p90ReleaseJitterNs,
+            w.p99ReleaseJitterNs, w.p999ReleaseJitterNs, w.avgReleaseJitterNs};
+}
+
+void appendText(std::string& out, const char* label, const Distribution& d)
+{
+    appendf(out, "   %-11s min=%.3f avg=%.3f p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f us\n",
+            label, d.min / 1e3, d.avg / 1e3, d.p50 / 1e3, d.p90 / 1e3, d.p99 / 1e3, d.p999 / 1e3,
+            d.max / 1e3);
+}
+
+// Per-job counter averages use the jobs count, so they may lag by one job
+double perJobAvg(const PerfStats& perf, int counter, long long jobs)
+{
+    return jobs > 0 ? double(perf.total[counter].load(std::memory_order_relaxed)) / double(jobs) : 0.0;
+}
+
+void appendJson(std::string& out, const char* key, const Distribution& d)
+{
+    appendf(out, "\"%s\":{\"min\":%lld,\"avg\":%.1f,\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,"
+                 "\"p999\":%lld,\"max\":%lld}",
+            key, d.min, d.avg, d.p50, d.p90, d.p99, d.p999, d.max);
+}
+} // namespace
+
+////////////////////////////////////////////
+// Snapshot
+////////////////////////////////////////////
+
+std::string StatsServer::snapshot(const Sequencer& seq, bool json)
+{
+    std::string out;
+    bool first = true;
+    long long nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    if (json) appendf(out, "{\"time_ns\":%lld,\"services\":[", nowNs);
+
+    seq.visitServices([&](const Service& svc) {
+        const RTStatistics& st = svc.stats;
+        Distribution exec = distribution(st.minExecNs, st.maxExecNs, st.avgExecNs(), st.execHist);
+        Distribution release = distribution(st.minReleaseJitterNs, st.maxReleaseJitterNs,
+                                            st.avgReleaseJitterNs(), st.releaseJitterHist);
+        Distribution cpu = distribution(st.minCpuNs, st.maxCpuNs, st.avgCpuNs(), st.cpuHist);
+        Distribution interference = distribution(st.minInterferenceNs, st.maxInterferenceNs,
+                                                 st.avgInterferenceNs(), st.interferenceHist);
+        Distribution response = distribution(st.minResponseNs, st.maxResponseNs, st.avgResponseNs(),
+                                             st.responseHist);
+        Distribution blocking = distribution(st.minBlockingNs, st.maxBlockingNs, st.avgBlockingNs(),
+                                             st.blockingHist);
+        bool sharesResources = !svc.resources.empty();
+        Distribution endToEnd = distribution(st.minEndToEndNs, st.maxEndToEndNs, st.avgEndToEndNs(),
+                                             st.endToEndHist);
+        bool chained = !svc.predecessors.empty();
+        long long periodNs = svc.periodNs.load(std::memory_order_relaxed);
+        long long jobs = st.count.load(std::memory_order_relaxed);
+        long long misses = st.deadlineMissCount.load(std::memory_order_relaxed);
+        long long overruns = st.overrunCount.load(std::memory_order_relaxed);
+
+        if (json)
+        {
+            if (!first) out += ',';
+            out += "{\"name\":" + jsonString(svc.name);
+            appendf(out, ",\"period_ns\":%lld,\"priority\":%d,\"cpu\":%d,\"jobs\":%lld,"
+                         "\"deadline_misses\":%lld,\"overruns\":%lld,",
+                    periodNs, svc.priority, svc.cpuAffinity, jobs, misses, overruns);
+            appendJson(out, "exec_ns", exec);
+            out += ',';
+            appendJson(out, "cpu_ns", cpu);
+            out += ',';
+            appendJson(out, "interference_ns", interference);
+            out += ',';
+            appendJson(out, "response_ns", response);
+            out += ',';
+            if (sharesResources)
+            {
+                appendJson(out, "blocking_ns", blocking);
+                out += ',';
+            }
+            if (chained)
+            {
+                appendJson(out, "end_to_end_ns", endToEnd);
+                out += ',';
+            }
+            appendJson(out, "release_jitter_ns", release);
+            appendf(out, ",\"exec_jitter_ns\":{\"min\":%lld,\"avg\":%.1f,\"max\":%lld}",
+                    minOrZero(st.minExecJitterNs), st.avgExecJitterNs(),
+                    st.maxExecJitterNs.load(std::memory_order_relaxed));
+
+            // Counters this worker could open
+            if (svc.perf)
+            {
+                out += ",\"perf\":{";
+                for (int i = 0; i < PERF_COUNTERS; i++)
+                {
+                    if (!svc.perf->available(static_cast<PerfCounter>(i))) continue;
+                    if (out.back() != '{') out += ',';
+                    appendf(out, "\"%s\":{\"total\":%lld,\"avg\":%.1f,\"p50\":%lld,\"p99\":%lld}",
+                            perfCounterNames[i], svc.perf->total[i].load(std::memory_order_relaxed),
+                            perJobAvg(*svc.perf, i, jobs), svc.perf->perJob[i].percentile(0.50),
+                            svc.perf->perJob[i].percentile(0.99));
+                }
+                out += '}';
+            }
+
+            // Last closed window of each length
+            out += ",\"windows\":[";
+            WindowSummary w;
+            for (size_t i = 0; svc.windows && i < svc.windows->lengths.size(); i++)
+            {
+                if (!svc.windows->last(i, w)) continue;
+                if (out.back() != '[') out += ',';
+                appendf(out, "{\"length_ms\":%lld,\"jobs\":%lld,\"deadline_misses\":%lld,\"overruns\":%lld,",
+                        static_cast<long long>(w.length.count()), w.jobs, w.deadlineMisses, w.overruns);
+                appendJson(out, "exec_ns", execOf(w));
+                out += ',';
+                appendJson(out, "release_jitter_ns", releaseJitterOf(w));
+                out += '}';
+            }
+            out += "]}";
+        }
+        else
+        {
+            appendf(out, "%s: period=%.3f ms prio=%d cpu=%d jobs=%lld misses=%lld overruns=%lld\n",
+                    svc.name.c_str(), periodNs / 1e6, svc.priority, svc.cpuAffinity, jobs, misses,
+                    overruns);
+            appendText(out, "ExecTime:", exec);
+            appendText(out, "CpuTime:", cpu);
+            appendText(out, "Interfere:", interference);
+            appendText(out, "Response:", response);
+            if (sharesResources) appendText(out, "Blocking:", blocking);
+            if (chained) appendText(out, "EndToEnd:", endToEnd);
+            appendText(out, "ReleaseJit:", release);
+            appendf(out, "   %-11s min=%.3f avg=%.3f max=%.3f us\n", "ExecJitter:",
+                    minOrZero(st.minExecJitterNs) / 1e3, st.avgExecJitterNs() / 1e3,
+                    st.maxExecJitterNs.load(std::memory_order_relaxed) / 1e3);
+
+            if (svc.perf)
+            {
+                for (int i = 0; i < PERF_COUNTERS; i++)
+                {
+                    if (!svc.perf->available(static_cast<PerfCounter>(i))) continue;
+                    appendf(out, "   %-16s total=%lld per job: avg=%.1f p50=%lld p99=%lld\n",
+                            perfCounterNames[i], svc.perf->total[i].load(std::memory_order_relaxed),
+                            perJobAvg(*svc.perf, i, jobs), svc.perf->perJob[i].percentile(0.50),
+                            svc.perf->perJob[i].percentile(0.99));
+                }
+            }
+
+            // Last closed window of each length
+            WindowSummary w;
+            for (size_t i = 0; svc.windows && i < svc.windows->lengths.size(); i++)
+            {
+                if (!svc.windows->last(i, w)) continue;
+                appendf(out, "   last %.3fs window: jobs=%lld misses=%lld overruns=%lld\n",
+                        w.length.count() / 1e3, w.jobs, w.deadlineMisses, w.overruns);
+                appendText(out, "  ExecTime:", execOf(w));
+                appendText(out, "  ReleaseJit:", releaseJitterOf(w));
+            }
+        }
+        first = false;
+    });
+
+    if (json) out += "]}\n";
+    return out;
+}
+
+////////////////////////////////////////////
+// Server
+////////////////////////////////////////////
+
+StatsServer::StatsServer(const Sequencer& seq, std::string socketPath)
+    : seq(seq), socketPath(std::move(socketPath))
+{
+}
+
+StatsServer::~StatsServer()
+{
+    stop();
+}
+
+bool StatsServer::start()
+{
+    if (running) return true;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "stats: socket path too long: " << socketPath << "\n";
+        return false;
+    }
+    memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+    {
+        std::cerr << "stats: socket failed: " << strerror(errno) << "\n";
+        return false;
+    }
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd, 4) < 0)
+    {
+        std::cerr << "stats: bind/listen " << socketPath << " failed: " << strerror(errno) << "\n";
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    if (pipe2(wakePipe, O_CLOEXEC) < 0)
+    {
+        std::cerr << "stats: pipe failed: " << strerror(errno) << "\n";
+        close(listenFd);
+        listenFd = -1;
+        unlink(socketPath.c_str());
+        return false;
+    }
+
+    // Never RT, whatever the creating thread runs as
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    sched_param param{};
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+    int err = pthread_create(&thread, &attr, threadEntry, this);
+    pthread_attr_destroy(&attr);
+    if (err != 0)
+    {
+        std::cerr << "stats: pthread_create failed: " << strerror(err) << "\n";
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+        close(listenFd);
+        listenFd = -1;
+        unlink(socketPath.c_str());
+        return false;
+    }
+
+    running = true;
+    return true;
+}
+
+void StatsServer::stop()
+{
+    if (!running) return;
+
+    char byte = 0;
+    if (write(wakePipe[1], &byte, 1) < 0)
+    {
+        std::cerr << "stats: wake failed: " << strerror(errno) << "\n";
+    }
+    pthread_join(thread, nullptr);
+
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    close(listenFd);
+    listenFd = -1;
+    unlink(socketPath.c_str());
+    running = false;
+}
+
+void* StatsServer::threadEntry(void* arg)
+{
+    static_cast<StatsServer*>(arg)->serve();
+    return nullptr;
+}
+
+void StatsServer::serve()
+{
+    // Below every default thread too
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), STATS_NICE);
+
+    pollfd fds[2];
+    fds[0] = {listenFd, POLLIN, 0};
+    fds[1] = {wakePipe[0], POLLIN, 0};
+
+    while (true)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            std::cerr << "stats: poll failed: " << strerror(errno) << "\n";
+            return;
+        }
+        if (fds[1].revents) return;  // stop()
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientFd < 0) continue;
+        answer(clientFd);
+        close(clientFd);
+    }
+}
+
+void StatsServer::answer(int clientFd)
+{
+    timeval timeout{0, CLIENT_TIMEOUT_MS * 1000};
+    setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // First line is the request; a client that sends nothing gets text
+    char request[64];
+    size_t len = 0;
+    while (len < sizeof(request) - 1)
+    {
+        ssize_t n = recv(clientFd, request + len, sizeof(request) - 1 - len, 0);
+        if (n <= 0) break;
+        len += static_cast<size_t>(n);
+        if (memchr(request, '\n', len)) break;
+    }
+    request[len] = '\0';
+    request[strcspn(request, "\r\n")] = '\0';
+
+    std::string reply;
+    if (strcmp(request, "json") == 0)                           reply = snapshot(seq, true);
+    else if (strcmp(request, "text") == 0 || request[0] == '\0') reply = snapshot(seq, false);
+    else                                                         reply = "unknown request (text|json)\n";
+
+    const char* p = reply.data();
+    size_t left = reply.size();
+    while (left > 0)
+    {
+        ssize_t n = send(clientFd, p, left, MSG_NOSIGNAL);
+        if (n <= 0) return;  // gone or too slow
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Sequencer.hpp"
+#include <string>
+#include <pthread.h>
+
+////////////////////////////////////////////
+// Live statistics over a Unix domain socket
+////////////////////////////////////////////
+// A low priority (SCHED_OTHER, niced) thread that answers each connection
+// with one snapshot of every service's RTStatistics and closes it:
+//
+//    echo text | nc -U /tmp/sequencer.sock
+//    echo json | nc -U /tmp/sequencer.sock
+//
+// The request is the first line sent ("text" or "json"; nothing at all means
+// text). Lifetime statistics come first, then the last closed window of each
+// length when windows are enabled (Sequencer::enableWindows()). Snapshots
+// only load the statistics atomics, so a slow or stuck client never holds up
+// a worker.
+class StatsServer
+{
+public:
+    StatsServer(const Sequencer& seq, std::string socketPath);
+    ~StatsServer();
+
+    StatsServer(const StatsServer&) = delete;
+    StatsServer& operator=(const StatsServer&) = delete;
+
+    // Bind the socket and start serving. Returns false (and prints why) on
+    // failure. A stale socket file at the path is replaced.
+    bool start();
+
+    // Stop serving and remove the socket file
+    void stop();
+
+    // One snapshot of all services, as served
+    static std::string snapshot(const Sequencer& seq, bool json);
+
+private:
+    const Sequencer& seq;
+    std::string socketPath;
+
+    int listenFd{-1};
+    int wakePipe[2]{-1, -1};  // written by stop() to end serve()
+    pthread_t thread{};
+    bool running{false};
+
+    static void* threadEntry(void* arg);
+    void serve();
+    void answer(int clientFd);
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+////////////////////////////////////////////
+// Shared-memory telemetry layout (version 1)
+////////////////////////////////////////////
+// A Sequencer with telemetry enabled publishes into the POSIX shared memory
+// object /sequencer.<pid> (i.e. /dev/shm/sequencer.<pid>), or the name given
+// to Sequencer::enableTelemetry(). The object is:
+//
+//    TelemetryHeader                      (64 bytes)
+//    TelemetryService[serviceCount]       (serviceSize bytes each)
+//
+// Native byte order, all integers 64-bit aligned, no pointers, so any
+// language can read it. Readers check magic, version, headerSize and
+// serviceSize before trusting anything else.
+//
+// Each TelemetryService is guarded by its own seqlock: the worker makes
+// `seq` odd, writes, then makes it even again. A reader copies the entry
+// and keeps the copy only if `seq` was even and unchanged across the copy
+// (see telemetryRead()). The worker never waits for readers and never
+// makes a syscall to publish.
+
+#define SEQ_TELEMETRY_MAGIC   0x54514553u   // "SEQT"
+#define SEQ_TELEMETRY_VERSION 1u
+#define SEQ_TELEMETRY_RING    64            // recent releases kept per service
+#define SEQ_TELEMETRY_NAME    32            // service name, NUL padded
+
+enum TelemetryState : uint32_t
+{
+    TELEMETRY_STARTING = 0,   // segment being set up
+    TELEMETRY_RUNNING  = 1,   // services running
+    TELEMETRY_STOPPED  = 2,   // stopServices() done, numbers are final
+};
+
+struct TelemetryHeader
+{
+    uint32_t magic;           // SEQ_TELEMETRY_MAGIC
+    uint32_t version;         // SEQ_TELEMETRY_VERSION
+    uint32_t headerSize;      // sizeof(TelemetryHeader)
+    uint32_t serviceSize;     // sizeof(TelemetryService)
+    uint32_t serviceCount;
+    uint32_t ringSize;        // SEQ_TELEMETRY_RING
+    int32_t  pid;             // publishing process
+    uint32_t state;           // TelemetryState
+    int64_t  startNs;         // CLOCK_MONOTONIC when services started
+    uint8_t  reserved[24];
+};
+
+// One job, as the worker saw it
+#define TELEMETRY_RELEASE_MISSED 0x1  // flags: deadline missed
+
+struct TelemetryRelease
+{
+    int64_t releaseNs;        // planned release, CLOCK_MONOTONIC
+    int64_t jitterNs;         // start - planned release
+    int64_t execNs;           // execution time
+    int64_t flags;            // TELEMETRY_RELEASE_*
+};
+
+struct TelemetryService
+{
+    uint64_t seq;             // seqlock, odd while being written
+    char     name[SEQ_TELEMETRY_NAME];
+    int64_t  periodNs;
+    int32_t  priority;
+    int32_t  cpu;             // -1: not pinned
+
+    // Running totals, same meaning as RTStatistics
+    int64_t  jobs;
+    int64_t  deadlineMisses;
+    int64_t  overruns;
+    int64_t  execMinNs;
+    int64_t  execMaxNs;
+    int64_t  execTotalNs;
+    int64_t  releaseJitterMinNs;
+    int64_t  releaseJitterMaxNs;
+    int64_t  releaseJitterTotalNs;
+    int64_t  updatedNs;       // CLOCK_MONOTONIC of the last publish
+
+    // Jobs published so far; the latest is ring[(ringHead - 1) % ringSize]
+    uint64_t ringHead;
+    TelemetryRelease ring[SEQ_TELEMETRY_RING];
+};
+
+static_assert(sizeof(TelemetryHeader) == 64, "telemetry header layout");
+static_assert(sizeof(TelemetryService) % 8 == 0, "telemetry service layout");
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "telemetry needs lock-free 64-bit atomics");
+
+////////////////////////////////////////////
+// Seqlock helpers
+////////////////////////////////////////////
+// Every word is stored / loaded as a relaxed atomic, so the reader's racing
+// copy is well defined; the fences order the words against `seq`.
+
+inline void telemetryStore(int64_t& field, int64_t value)
+{
+    std::atomic_ref<int64_t>(field).store(value, std::memory_order_relaxed);
+}
+
+inline void telemetryWriteBegin(TelemetryService& t)
+{
+    std::atomic_ref<uint64_t> seq(t.seq);
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void telemetryWriteEnd(TelemetryService& t)
+{
+    std::atomic_ref<uint64_t> seq(t.seq);
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Consistent copy of `src` into `dst`, retrying while the worker is mid
+// write. Returns false if it never got a clean copy in `attempts` tries.
+inline bool telemetryRead(const TelemetryService& src, TelemetryService& dst, int attempts = 1000)
+{
+    auto* words = reinterpret_cast<uint64_t*>(const_cast<TelemetryService*>(&src));
+    auto* out = reinterpret_cast<uint64_t*>(&dst);
+    constexpr size_t count = sizeof(TelemetryService) / sizeof(uint64_t);
+
+    for (int i = 0; i < attempts; i++)
+    {
+        uint64_t before = std::atomic_ref<uint64_t>(words[0]).load(std::memory_order_acquire);
+        if (before & 1) continue;
+        for (size_t w = 1; w < count; w++)
+        {
+            out[w] = std::atomic_ref<uint64_t>(words[w]).load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = std::atomic_ref<uint64_t>(words[0]).load(std::memory_order_relaxed);
+        if (before == after)
+        {
+            out[0] = before;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,131 @@
+// Joins (Sequencer::addDependency() with several predecessors) in virtual
+// time: a join runs once per completed job of each of its predecessors, at
+// the rate of the slowest, whatever their rates and phases.
+//
+//   make test            # from the top level
+//   ./JoinTest
+
+#include "Sequencer.hpp"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+using namespace std::chrono;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+// Predecessors at `periodsMs` (priority high to low), all joined by "join".
+// Checks that every join job had a new completion of every predecessor
+// behind it, and that it ran as often as the slowest.
+static void runJoin(const char* what, std::vector<int> periodsMs, int offsetMs = 0)
+{
+    VirtualClock clock;
+    Sequencer seq;
+    seq.useVirtualClock(clock);
+
+    std::vector<int> completed(periodsMs.size(), 0);  // since the last join job
+    int joins = 0, early = 0, slowest = 0;
+    for (size_t i = 0; i < periodsMs.size(); i++)
+    {
+        std::string name = "pred" + std::to_string(i);
+        seq.addService(name, [&, i] {
+            clock.advance(microseconds(100));
+            completed[i]++;
+        }, 90 - int(i), 0, periodsMs[i]);
+        if (i == periodsMs.size() - 1 && offsetMs > 0)
+        {
+            seq.setReleaseTiming(name, milliseconds(offsetMs), nanoseconds(0));
+        }
+    }
+    seq.addService("join", [&] {
+        clock.advance(microseconds(100));
+        for (int& n : completed)
+        {
+            if (n == 0) early++;
+            n = 0;
+        }
+        joins++;
+    }, 50, 0, 0);
+    for (size_t i = 0; i < periodsMs.size(); i++)
+    {
+        if (!seq.addDependency("join", "pred" + std::to_string(i))) check(false, "addDependency");
+    }
+    seq.addService("count", [&] { slowest++; }, 10, 0, *std::max_element(periodsMs.begin(), periodsMs.end()));
+    if (offsetMs > 0) seq.setReleaseTiming("count", milliseconds(offsetMs), nanoseconds(0));
+
+    auto start = clock.now();
+    seq.startServices(milliseconds(1));
+    seq.simulateUntil(start + milliseconds(400) - microseconds(500));
+    seq.stopServices();
+
+    printf("      %s: %d joins, %d releases of the slowest\n", what, joins, slowest);
+    check(early == 0, (std::string(what) + ": no join without every predecessor").c_str());
+    check(joins == slowest, (std::string(what) + ": joins at the rate of the slowest").c_str());
+}
+
+// Real workers: predecessors triggered from two threads at unrelated rates,
+// so their completions race each other and the join's round changes. Every
+// join must report the earliest head of its own round: never one from a
+// later round (a negative latency) or a lost one.
+static void runThreadedJoin()
+{
+    Sequencer seq;
+    std::atomic<long long> fastJobs{0}, slowJobs{0}, joins{0};
+    auto work = [](int us) {
+        auto until = steady_clock::now() + microseconds(us);
+        while (steady_clock::now() < until)
+            ;
+    };
+    seq.addService("fast", [&] { work(20); fastJobs++; }, 0, -1, 0);
+    seq.addService("slow", [&] { work(50); slowJobs++; }, 0, -1, 0);
+    seq.addService("join", [&] { joins++; }, 0, -1, 0);
+    seq.addDependency("join", "fast");
+    seq.addDependency("join", "slow");
+    if (!seq.startServices(milliseconds(1)))
+    {
+        check(false, "threaded join: startServices");
+        return;
+    }
+
+    std::atomic<bool> stop{false};
+    auto triggerAt = [&](const char* name, int periodUs) {
+        ServiceTrigger trigger = seq.getTrigger(name);
+        while (!stop)
+        {
+            trigger.release();
+            std::this_thread::sleep_for(microseconds(periodUs));
+        }
+    };
+    std::thread fast(triggerAt, "fast", 100);
+    std::thread slow(triggerAt, "slow", 330);
+    std::this_thread::sleep_for(milliseconds(1500));
+    stop = true;
+    fast.join();
+    slow.join();
+    seq.stopServices();
+
+    const RTStatistics& st = *seq.getStatistics("join");
+    printf("      threaded: %lld fast, %lld slow, %lld joins, end to end %.3f .. %.3f ms\n",
+           fastJobs.load(), slowJobs.load(), joins.load(), st.minEndToEndNs.load() / 1e6,
+           st.maxEndToEndNs.load() / 1e6);
+    check(joins > 0 && joins <= slowJobs, "threaded join: at most once per slow job");
+    check(st.minEndToEndNs.load() >= 0, "threaded join: no head from a later round");
+    check(st.maxEndToEndNs.load() < 1000000000LL, "threaded join: no lost head");
+}
+
+int main()
+{
+    runJoin("fast 10 ms + slow 40 ms", {10, 40});
+    runJoin("10 + 20 + 40 ms", {10, 20, 40});
+    runJoin("slow one 5 ms out of phase", {10, 40}, 5);
+    runThreadedJoin();
+
+    printf("%s\n", failures == 0 ? "JoinTest: OK" : "JoinTest: FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+// Operating modes (Sequencer::defineMode()) in virtual time: a requested
+// switch happens at the running mode's next hyperperiod boundary, and from
+// there on the new mode's periods and priorities are in effect.
+//
+//   make test            # from the top level
+//   ./ModeTest
+
+#include "Sequencer.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what)
+{
+    printf("%s: %s\n", ok ? "ok  " : "FAIL", what.c_str());
+    if (!ok) failures++;
+}
+
+struct Job
+{
+    char service;
+    long long startMs;  // since the first tick
+};
+
+int main()
+{
+    VirtualClock clock;
+    Sequencer seq;
+    seq.useVirtualClock(clock);
+
+    std::vector<Job> jobs;
+    auto start = clock.now() + milliseconds(1);  // the first tick
+    auto job = [&](char service) {
+        return [&, service] {
+            jobs.push_back({service, duration_cast<milliseconds>(clock.now() - start).count()});
+            clock.advance(milliseconds(1));
+        };
+    };
+    seq.addService("a", job('a'), 50, 0, 10);
+    seq.addService("b", job('b'), 40, 0, 20);
+
+    // Hyperperiod 20 ms; "fast" halves both periods and puts b above a
+    check(seq.defineMode("normal", {{"a", milliseconds(10)}, {"b", milliseconds(20)}}), "define normal");
+    check(seq.defineMode("fast", {{"a", milliseconds(5), 60}, {"b", milliseconds(10), 70}}), "define fast");
+    seq.startServices(milliseconds(1));
+    check(seq.currentMode() == "normal", "starts in the first mode");
+
+    // Asked 32 ms in: the boundary is at 40 ms
+    seq.simulateUntil(start + milliseconds(32));
+    check(seq.requestMode("fast"), "requestMode");
+    check(!seq.requestMode("normal"), "a second request while one is pending");
+    seq.simulateUntil(start + milliseconds(39));
+    check(seq.currentMode() == "normal", "normal until the boundary");
+    seq.simulateUntil(start + milliseconds(80) - microseconds(500));
+    check(seq.currentMode() == "fast", "fast after the boundary");
+    seq.stopServices();
+
+    auto count = [&](char service, long long fromMs, long long toMs) {
+        int n = 0;
+        for (const Job& j : jobs) n += j.service == service && j.startMs >= fromMs && j.startMs < toMs;
+        return n;
+    };
+    auto firstAt = [&](long long ms) {
+        for (const Job& j : jobs)
+        {
+            if (j.startMs >= ms) return j;
+        }
+        return Job{'-', -1};
+    };
+
+    printf("      jobs:");
+    for (const Job& j : jobs) printf(" %c@%lld", j.service, j.startMs);
+    printf("\n");
+    check(count('a', 0, 40) == 4 && count('b', 0, 40) == 2, "normal: 10 and 20 ms periods");
+    check(firstAt(0).service == 'a' && firstAt(20).service == 'a', "normal: a runs first");
+    check(firstAt(40).startMs == 40, "the switch is at the boundary");
+    check(count('a', 40, 80) == 8 && count('b', 40, 80) == 4, "fast: 5 and 10 ms periods");
+    check(firstAt(40).service == 'b' && firstAt(50).service == 'b' && firstAt(60).service == 'b',
+          "fast: b runs first");
+
+    int priorityA = 0, priorityB = 0;
+    seq.visitServices([&](const Service& svc) {
+        if (svc.name == "a") priorityA = svc.modePriority.load();
+        if (svc.name == "b") priorityB = svc.modePriority.load();
+    });
+    check(priorityA == 60 && priorityB == 70, "fast: its priorities");
+
+    printf("ModeTest: %s\n", failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+// Service configuration files (ServiceConfig.hpp): durations, the TOML
+// subset the parser takes and rejects, and ConfigWatcher::reload().
+// Rejected files print why on stderr, as they would for a user.
+//
+//   make test            # from the top level
+//   ./ServiceConfigTest
+
+#include "ServiceConfig.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace std::chrono;
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what)
+{
+    printf("%s: %s\n", ok ? "ok  " : "FAIL", what.c_str());
+    if (!ok) failures++;
+}
+
+static const std::string path = "/tmp/ServiceConfigTest." + std::to_string(getpid()) + ".toml";
+
+static void writeFile(const std::string& text)
+{
+    std::ofstream(path) << text;
+}
+
+static bool loadText(const std::string& text, SequencerConfig& out)
+{
+    writeFile(text);
+    return SequencerConfig::load(path, out);
+}
+
+static bool loads(const std::string& text)
+{
+    SequencerConfig config;
+    return loadText(text, config);
+}
+
+// A service table with the required keys and `extra`
+static std::string service(const std::string& name, const std::string& extra = "")
+{
+    return "[[service]]\nname = \"" + name + "\"\npriority = 0\n" + extra;
+}
+
+static void testDurations()
+{
+    struct Case
+    {
+        const char* text;
+        bool ok;
+        long long ns;
+    };
+    const Case cases[] = {
+        {"250ns", true, 250},
+        {"40us", true, 40000},
+        {"10ms", true, 10000000},
+        {"2s", true, 2000000000},
+        {"1.5ms", true, 1500000},
+        {"100", true, 100000},                 // bare: microseconds
+        {"0", true, 0},
+        {"", false, 0},
+        {"10 ms", false, 0},
+        {"10min", false, 0},
+        {"-1ms", false, 0},
+        {"1e400s", false, 0},                  // inf
+        {"10000000000s", false, 0},            // past what nanoseconds hold
+    };
+    for (const Case& c : cases)
+    {
+        nanoseconds d{-1};
+        bool ok = parseDuration(c.text, d);
+        check(ok == c.ok && (!ok || d.count() == c.ns), std::string("duration \"") + c.text + "\"");
+    }
+
+    SequencerConfig config;
+    check(loadText(service("a", "period = 2500\n"), config) && config.services[0].period == microseconds(2500),
+          "integer period: microseconds");
+    check(loadText(service("a", "period = \"2500\"\n"), config) && config.services[0].period == microseconds(2500),
+          "bare string period: microseconds");
+    check(!loads(service("a", "period = 9223372036854776\n")), "integer period out of range");
+    check(!loads(service("a", "period = \"-5ms\"\n")), "negative period");
+    check(!loads(service("a", "period = 99999999999999999999\n")), "integer past long long");
+    check(loadText("[sequencer]\nmaster_interval = \"250us\"\n", config)
+              && config.masterInterval == microseconds(250),
+          "master_interval");
+    check(!loads("[sequencer]\nmaster_interval = \"500ns\"\n"), "master_interval under 1us");
+}
+
+static void testTables()
+{
+    check(loads("[sequencer]\nstrict_real_time = true\n" + service("a", "period = \"10ms\"\n")), "valid file");
+    check(!loads(service("a", "period = \"10ms\"\npriority = 5\n")), "duplicate key");
+    check(!loads("[sequencer]\n[sequencer]\n"), "duplicate [sequencer]");
+    check(!loads(service("a", "period = 1\n") + service("a", "period = 2\n")), "duplicate service name");
+    check(!loads("[services]\n"), "unknown table");
+    check(!loads("[[sequencer]]\n"), "[[sequencer]]");
+    check(!loads(service("a", "period = 1\nperiode = 2\n")), "unknown key in [[service]]");
+    check(!loads("[sequencer]\ntick = \"1ms\"\n"), "unknown key in [sequencer]");
+    check(!loads("period = 1\n"), "key outside of any table");
+    check(!loads("[[service]]\nname = \"a\"\nperiod = 1\n"), "missing priority");
+    check(!loads(service("a", "period = 1\noverrun = \"drop\"\n")), "unknown overrun policy");
+    check(!loads(service("a", "period = 1\nstrict = yes\n")), "bare word value");
+}
+
+static void testAfter()
+{
+    SequencerConfig config;
+    check(loadText(service("a", "period = \"10ms\"\n") + service("b", "period = \"20ms\"\n")
+                       + service("join", "after = \" a ,b \"\n"), config)
+              && config.services[2].after == std::vector<std::string>({"a", "b"})
+              && config.services[2].period.count() == 0,
+          "after, trimmed, no period");
+    check(!loads(service("a", "period = \"10ms\"\n") + service("b", "after = \"a\"\nperiod = \"10ms\"\n")),
+          "after with a period");
+    check(!loads(service("a", "period = \"10ms\"\n") + service("b", "period = \"10ms\"\nafter = \"a\"\n")),
+          "period, then after");
+    check(!loads(service("a", "period = \"10ms\"\n") + service("b", "after = \"a, c\"\n")), "after an unknown service");
+    check(!loads(service("a", "after = \"a\"\n")), "after itself");
+    check(!loads(service("a", "period = \"10ms\"\n") + service("b", "after = \"a,\"\n")), "after, empty name");
+}
+
+static void testStrings()
+{
+    SequencerConfig config;
+    check(loadText(service("a", "period = 1\nbackend = \"x#y\"   # comment\n"), config)
+              && config.services[0].backend == "x#y",
+          "# inside a string");
+    check(loadText(service("a", "period = 1\nbackend = \"say \\\"hi\\\" # still\"  # comment \"\n"), config)
+              && config.services[0].backend == "say \"hi\" # still",
+          "escaped quotes and # inside a string");
+    check(loadText(service("a", "period = 1 # \"quoted\" comment\n"), config)
+              && config.services[0].period == microseconds(1),
+          "quotes inside a comment");
+    check(!loads(service("a", "period = 1\nbackend = \"a\"b\"\n")), "unescaped quote inside a string");
+    check(!loads(service("a", "period = 1\nbackend = \"open\n")), "unterminated string");
+}
+
+static void testReload()
+{
+    const std::string before = "[sequencer]\nmaster_interval = \"1ms\"\n"
+                               + service("a", "period = \"10ms\"\n") + service("b", "period = \"20ms\"\n");
+    SequencerConfig config;
+    if (!loadText(before, config))
+    {
+        check(false, "reload: initial file");
+        return;
+    }
+
+    VirtualClock clock;
+    Sequencer seq;
+    seq.useVirtualClock(clock);
+    ServiceRegistry registry;
+    registry.add("a", [] {});
+    registry.add("b", [] {});
+    check(config.apply(seq, registry), "reload: apply");
+    seq.startServices(config.masterInterval);
+
+    auto periodOf = [&](const std::string& name) {
+        long long ns = 0;
+        seq.visitServices([&](const Service& svc) {
+            if (svc.name == name) ns = svc.periodNs.load();
+        });
+        return ns;
+    };
+
+    ConfigWatcher watcher(seq, path, config);
+    writeFile("[sequencer]\nmaster_interval = \"1ms\"\n" + service("a", "period = \"5ms\"\n")
+              + service("b", "period = \"20ms\"\n"));
+    check(watcher.reload() == 1 && periodOf("a") == 5000000, "reload: period change applied");
+
+    writeFile("[sequencer]\nmaster_interval = \"1ms\"\n" + service("a", "period = \"5ms\"\ndeadline = \"4ms\"\n")
+              + service("b", "period = \"20ms\"\ncpu = 0\n"));
+    check(watcher.reload() == 0 && periodOf("a") == 5000000, "reload: other changes need a restart");
+
+    writeFile("[sequencer\n");
+    check(watcher.reload() == -1 && periodOf("a") == 5000000, "reload: unparsable file kept out");
+
+    writeFile(before);
+    check(watcher.reload() == 1 && periodOf("a") == 10000000, "reload: back to the first period");
+
+    seq.stopServices();
+}
+
+int main()
+{
+    testDurations();
+    testTables();
+    testAfter();
+    testStrings();
+    testReload();
+    unlink(path.c_str());
+
+    printf("ServiceConfigTest: %s\n", failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// Statistics in virtual time (Sequencer::useVirtualClock()): a run is
+// reproducible, and its overruns and deadline misses are those the jobs'
+// clock.advance() calls make, whatever the host does.
+//
+//   make test            # from the top level
+//   ./VirtualTimeTest
+
+#include "Sequencer.hpp"
+#include "Channel.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what)
+{
+    printf("%s: %s\n", ok ? "ok  " : "FAIL", what.c_str());
+    if (!ok) failures++;
+}
+
+// The statistics of every service, in a comparable form
+static std::vector<long long> snapshot(const Sequencer& seq)
+{
+    std::vector<long long> out;
+    seq.visitServices([&](const Service& svc) {
+        const RTStatistics& st = *seq.getStatistics(svc.name);
+        for (const std::atomic<long long>* v :
+             {&st.count, &st.minExecNs, &st.maxExecNs, &st.totalExecNs, &st.releaseCount,
+              &st.minReleaseJitterNs, &st.maxReleaseJitterNs, &st.totalReleaseJitterNs, &st.minResponseNs,
+              &st.maxResponseNs, &st.totalResponseNs, &st.deadlineMissCount, &st.overrunCount,
+              &st.collapsedCount})
+        {
+            out.push_back(v->load());
+        }
+    });
+    return out;
+}
+
+// Three services, one of them Skip, whose jobs now and then run past their
+// period
+static std::vector<long long> runMixed(long long& overruns)
+{
+    VirtualClock clock;
+    Sequencer seq;
+    seq.useVirtualClock(clock);
+
+    int fastJobs = 0, midJobs = 0, slowJobs = 0;
+    seq.addService("fast", [&] { clock.advance(milliseconds(fastJobs++ % 7 == 6 ? 6 : 1)); }, 90, 0, 5);
+    seq.addService("mid", [&] { clock.advance(microseconds(1500 + 100 * (midJobs++ % 5))); }, 80, 0, 10);
+    seq.addService("slow", [&] { clock.advance(milliseconds(slowJobs++ % 9 == 4 ? 45 : 4)); }, 70, 0, 20);
+    seq.setOverrunPolicy("slow", OverrunPolicy::Skip);
+
+    auto start = clock.now();
+    seq.startServices(milliseconds(1));
+    seq.simulateUntil(start + seconds(1));
+    seq.stopServices();
+
+    overruns = 0;
+    for (const char* name : {"fast", "mid", "slow"}) overruns += seq.getStatistics(name)->overrunCount.load();
+    return snapshot(seq);
+}
+
+// One service at 10 ms whose fourth job runs 25 ms: the releases at 40 and
+// 50 ms into its period grid come due while it runs.
+static void runOverrun(OverrunPolicy policy, const char* what, long long jobs, long long overruns,
+                       long long collapsed, long long misses)
+{
+    VirtualClock clock;
+    Sequencer seq;
+    seq.useVirtualClock(clock);
+
+    int n = 0;
+    seq.addService("svc", [&] { clock.advance(milliseconds(n++ == 3 ? 25 : 1)); }, 90, 0, 10);
+    seq.setOverrunPolicy("svc", policy);
+
+    auto start = clock.now();
+    seq.startServices(milliseconds(1));
+    seq.simulateUntil(start + milliseconds(100));
+    seq.stopServices();
+
+    const RTStatistics& st = *seq.getStatistics("svc");
+    printf("      %s: %lld jobs, %lld overruns, %lld collapsed, %lld deadline misses\n", what, st.count.load(),
+           st.overrunCount.load(), st.collapsedCount.load(), st.deadlineMissCount.load());
+    check(st.count.load() == jobs, std::string(what) + ": jobs");
+    check(st.overrunCount.load() == overruns, std::string(what) + ": overruns");
+    check(st.collapsedCount.load() == collapsed, std::string(what) + ": collapsed releases");
+    check(st.deadlineMissCount.load() == misses, std::string(what) + ": deadline misses");
+    check(st.maxResponseNs.load() == nanoseconds(milliseconds(25)).count(), std::string(what) + ": worst response");
+}
+
+// A producer that sends, then works 3 ms; its consumer runs right after it:
+// every message waits 3 ms of virtual time
+static void runChannel()
+{
+    VirtualClock clock;
+    Sequencer seq;
+    seq.useVirtualClock(clock);
+
+    SpscChannel<int, 8> channel;
+    int sent = 0, received = 0;
+    seq.addService("producer", [&] {
+        channel.send(sent++);
+        clock.advance(milliseconds(3));
+    }, 90, 0, 10);
+    seq.addService("consumer", [&] {
+        int value;
+        while (channel.receive(value)) received++;
+    }, 80, 0, 10);
+
+    auto start = clock.now();
+    seq.startServices(milliseconds(1));
+    seq.simulateUntil(start + milliseconds(100));
+    seq.stopServices();
+
+    long long latency = nanoseconds(milliseconds(3)).count();
+    printf("      channel: %d received, latency %.3f .. %.3f ms\n", received, channel.stats.avgLatencyNs() / 1e6,
+           channel.stats.maxLatencyNs.load() / 1e6);
+    check(received == sent && received > 0, "channel: every message received");
+    check(channel.stats.maxLatencyNs.load() == latency && channel.stats.avgLatencyNs() == double(latency),
+          "channel: latency in virtual time");
+}
+
+int main()
+{
+    long long overruns1 = 0, overruns2 = 0;
+    std::vector<long long> first = runMixed(overruns1);
+    std::vector<long long> second = runMixed(overruns2);
+    printf("      mixed: %lld overruns\n", overruns1);
+    check(overruns1 > 0, "mixed: jobs run past their period");
+    check(first == second, "mixed: two runs give the same statistics");
+
+    // Queue: 40 runs late, right after the long job, and misses its
+    // deadline too; 50 collapses into it
+    runOverrun(OverrunPolicy::Queue, "Queue", 9, 2, 1, 2);
+    // Skip: 40 and 50 are dropped, the next job is 60, on time
+    runOverrun(OverrunPolicy::Skip, "Skip", 8, 2, 0, 1);
+
+    runChannel();
+
+    printf("VirtualTimeTest: %s\n", failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+/*
+ * Predict response times and deadline misses of a service set offline
+ *
+ *   ./SeqSim SPEC [--tick 1ms] [--hyperperiods 100 | --duration 60s] [--seed 1]
+ *                 [--format text|json]
+ *   ./SeqSim SPEC --grow SERVICE --target SERVICE [--quantile 0.999] [--max-copies 64] ...
+ *
+ * SPEC lists one service per line (# starts a comment):
+ *
+ *   # name          period  priority  cpu  exec time
+ *   gpio23_toggle   100ms   97        1    const:40us
+ *   logger          10ms    50        1    uniform:200us:800us
+ *   control         1ms     90        1    normal:150us:20us
+ *
+ * Times take ns / us / ms / s. Exec time models: const:T, uniform:MIN:MAX,
+ * normal:MEAN:SD (cut at 0), exp:MEAN. See ScheduleSim.hpp for the model:
+ * the Sequencer's own release logic in virtual time, fixed-priority
+ * preemptive scheduling per CPU.
+ *
+ * --grow adds copies of SERVICE, one more per run, until the --quantile
+ * response time of --target exceeds its period (or any of its releases is
+ * skipped), and reports how many fit.
+ */
+
+#include "ScheduleSim.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static bool loadSpec(const char* path, std::vector<SimServiceSpec>& specs)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); lineNo++)
+    {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+
+        std::istringstream words(line);
+        std::string name, period, priority, cpu, exec, extra;
+        if (!(words >> name)) continue;
+        if (!(words >> period >> priority >> cpu >> exec) || (words >> extra))
+        {
+            fprintf(stderr, "%s:%d: expected: name period priority cpu exec\n", path, lineNo);
+            return false;
+        }
+
+        SimServiceSpec spec;
+        spec.name = name;
+        std::chrono::nanoseconds periodNs;
+        if (!parseDuration(period, periodNs) || periodNs < std::chrono::microseconds(1))
+        {
+            fprintf(stderr, "%s:%d: bad period '%s'\n", path, lineNo, period.c_str());
+            return false;
+        }
+        spec.period = std::chrono::duration_cast<std::chrono::microseconds>(periodNs);
+        spec.priority = atoi(priority.c_str());
+        spec.cpu = atoi(cpu.c_str());
+        if (!ExecModel::parse(exec, spec.exec))
+        {
+            fprintf(stderr, "%s:%d: bad exec time\n", path, lineNo);
+            return false;
+        }
+        for (const SimServiceSpec& other : specs)
+        {
+            if (other.name == spec.name)
+            {
+                fprintf(stderr, "%s:%d: duplicate service '%s'\n", path, lineNo, name.c_str());
+                return false;
+            }
+        }
+        specs.push_back(spec);
+    }
+    if (specs.empty())
+    {
+        fprintf(stderr, "%s: no services\n", path);
+        return false;
+    }
+    return true;
+}
+
+static double us(long long ns)
+{
+    return ns / 1e3;
+}
+
+static void printText(const ScheduleSim& sim, const SimResult& result)
+{
+    printf("simulated %.3f s, hyperperiod %.3f ms\n", result.simulated.count() / 1e9,
+           sim.hyperperiod().count() / 1e3);
+    for (const SimCpuResult& cpu : result.cpus)
+    {
+        if (cpu.cpu < 0) printf("cpu unpinned: utilization %.1f%%\n", cpu.utilization * 100);
+        else printf("cpu %d: utilization %.1f%%\n", cpu.cpu, cpu.utilization * 100);
+    }
+    for (size_t i = 0; i < result.services.size(); i++)
+    {
+        const SimServiceResult& r = result.services[i];
+        const SimServiceSpec& spec = sim.services()[i];
+        printf("%s: period=%.3fms prio=%d cpu=%d exec=%s\n", r.name.c_str(), r.period.count() / 1e3,
+               spec.priority, r.cpu, spec.exec.describe().c_str());
+        printf("   releases=%lld completed=%lld misses=%lld skipped=%lld overruns=%lld miss rate=%.3g\n",
+               r.released, r.completed, r.deadlineMisses, r.skipped, r.overruns, r.missRate());
+        const std::vector<long long>& resp = r.responseNs;
+        printf("   Response:   p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f us\n",
+               us(SimServiceResult::quantile(resp, 0.5)), us(SimServiceResult::quantile(resp, 0.9)),
+               us(SimServiceResult::quantile(resp, 0.99)), us(SimServiceResult::quantile(resp, 0.999)),
+               us(SimServiceResult::quantile(resp, 1.0)));
+        const std::vector<long long>& delay = r.startDelayNs;
+        printf("   StartDelay: p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f max=%.3f us\n",
+               us(SimServiceResult::quantile(delay, 0.5)), us(SimServiceResult::quantile(delay, 0.9)),
+               us(SimServiceResult::quantile(delay, 0.99)), us(SimServiceResult::quantile(delay, 0.999)),
+               us(SimServiceResult::quantile(delay, 1.0)));
+    }
+}
+
+static void printJson(const ScheduleSim& sim, const SimResult& result)
+{
+    printf("{\"simulated_ns\":%lld,\"hyperperiod_us\":%lld,\"cpus\":[",
+           static_cast<long long>(result.simulated.count()), static_cast<long long>(sim.hyperperiod().count()));
+    for (size_t i = 0; i < result.cpus.size(); i++)
+    {
+        printf("%s{\"cpu\":%d,\"utilization\":%.6f}", i ? "," : "", result.cpus[i].cpu, result.cpus[i].utilization);
+    }
+    printf("],\"services\":[");
+    for (size_t i = 0; i < result.services.size(); i++)
+    {
+        const SimServiceResult& r = result.services[i];
+        printf("%s{\"name\":\"%s\",\"period_us\":%lld,\"cpu\":%d,\"released\":%lld,\"completed\":%lld,"
+               "\"deadline_misses\":%lld,\"skipped\":%lld,\"overruns\":%lld,\"miss_rate\":%.6g",
+               i ? "," : "", r.name.c_str(), static_cast<long long>(r.period.count()), r.cpu, r.released,
+               r.completed, r.deadlineMisses, r.skipped, r.overruns, r.missRate());
+        const char* keys[] = {"response_ns", "start_delay_ns"};
+        const std::vector<long long>* values[] = {&r.responseNs, &r.startDelayNs};
+        for (int k = 0; k < 2; k++)
+        {
+            const std::vector<long long>& v = *values[k];
+            printf(",\"%s\":{\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,\"p999\":%lld,\"max\":%lld}", keys[k],
+                   SimServiceResult::quantile(v, 0.5), SimServiceResult::quantile(v, 0.9),
+                   SimServiceResult::quantile(v, 0.99), SimServiceResult::quantile(v, 0.999),
+                   SimServiceResult::quantile(v, 1.0));
+        }
+        printf("}");
+    }
+    printf("]}\n");
+}
+
+// Does `target` still meet its period at `quantile` with `copies` of `grow`?
+static bool fits(const std::vector<SimServiceSpec>& base, size_t grow, size_t target, int copies,
+                 std::chrono::microseconds tick, int hyperperiods, std::chrono::nanoseconds duration,
+                 uint64_t seed, double quantile, long long& responseNs, double& utilization)
+{
+    std::vector<SimServiceSpec> specs = base;
+    for (int c = 1; c <= copies; c++)
+    {
+        SimServiceSpec copy = base[grow];
+        copy.name += "#" + std::to_string(c);
+        specs.push_back(copy);
+    }
+
+    ScheduleSim sim(specs, tick);
+    std::chrono::nanoseconds length = duration;
+    if (length.count() == 0) length = sim.hyperperiod() * hyperperiods;
+    SimResult result = sim.run(length, seed);
+
+    const SimServiceResult& r = result.services[target];
+    responseNs = SimServiceResult::quantile(r.responseNs, quantile);
+    utilization = 0;
+    int cpu = base[target].cpu < 0 ? -1 : base[target].cpu;
+    for (const SimCpuResult& c : result.cpus)
+    {
+        if (c.cpu == cpu) utilization = c.utilization;
+    }
+    return r.completed > 0 && r.skipped == 0 && responseNs <= std::chrono::nanoseconds(r.period).count();
+}
+
+int main(int argc, char* argv[])
+{
+    const char* specPath = nullptr;
+    std::chrono::nanoseconds tickNs = std::chrono::milliseconds(1);
+    std::chrono::nanoseconds duration{0};
+    int hyperperiods = 100;
+    uint64_t seed = 1;
+    bool json = false;
+    const char* grow = nullptr;
+    const char* target = nullptr;
+    double quantile = 0.999;
+    int maxCopies = 64;
+    bool usage = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool more = i + 1 < argc;
+        if (strcmp(argv[i], "--tick") == 0 && more && parseDuration(argv[i + 1], tickNs)) i++;
+        else if (strcmp(argv[i], "--duration") == 0 && more && parseDuration(argv[i + 1], duration)) i++;
+        else if (strcmp(argv[i], "--hyperperiods") == 0 && more) hyperperiods = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && more)         seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--format") == 0 && more)       json = strcmp(argv[++i], "json") == 0;
+        else if (strcmp(argv[i], "--grow") == 0 && more)         grow = argv[++i];
+        else if (strcmp(argv[i], "--target") == 0 && more)       target = argv[++i];
+        else if (strcmp(argv[i], "--quantile") == 0 && more)     quantile = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-copies") == 0 && more)   maxCopies = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !specPath)                 specPath = argv[i];
+        else usage = true;
+    }
+    if (usage || !specPath || hyperperiods < 1 || quantile < 0 || quantile > 1 || (!grow != !target))
+    {
+        fprintf(stderr, "usage: %s SPEC [--tick T] [--hyperperiods N | --duration T] [--seed N] [--format text|json]\n"
+                        "       %s SPEC --grow SERVICE --target SERVICE [--quantile Q] [--max-copies N] ...\n",
+                argv[0], argv[0]);
+        return 2;
+    }
+
+    std::vector<SimServiceSpec> specs;
+    if (!loadSpec(specPath, specs)) return 1;
+    auto tick = std::chrono::duration_cast<std::chrono::microseconds>(tickNs);
+    if (tick.count() < 1)
+    {
+        fprintf(stderr, "--tick must be at least 1us\n");
+        return 2;
+    }
+
+    // Coprime periods can make the hyperperiod impractically long
+    ScheduleSim sim(specs, tick);
+    if (duration.count() == 0)
+    {
+        auto h = sim.hyperperiod();
+        if (h.count() == 0 || h > std::chrono::hours(24) / hyperperiods)
+        {
+            fprintf(stderr, "hyperperiod is %s; give --duration instead\n",
+                    h.count() == 0 ? "too long to compute" : "over a day");
+            return 2;
+        }
+    }
+
+    if (!grow)
+    {
+        SimResult result = sim.run(duration.count() ? duration : sim.hyperperiod() * hyperperiods, seed);
+        if (json) printJson(sim, result);
+        else printText(sim, result);
+        return 0;
+    }
+
+    // Capacity planning
+    size_t growIndex = specs.size(), targetIndex = specs.size();
+    for (size_t i = 0; i < specs.size(); i++)
+    {
+        if (specs[i].name == grow) growIndex = i;
+        if (specs[i].name == target) targetIndex = i;
+    }
+    if (growIndex == specs.size() || targetIndex == specs.size())
+    {
+        fprintf(stderr, "no service named '%s'\n", growIndex == specs.size() ? grow : target);
+        return 2;
+    }
+
+    printf("copies,target_p%g_us,target_period_us,cpu_utilization,fits\n", quantile * 100);
+    int fitting = -1;
+    for (int copies = 0; copies <= maxCopies; copies++)
+    {
+        long long responseNs;
+        double utilization;
+        bool ok = fits(specs, growIndex, targetIndex, copies, tick, hyperperiods, duration, seed, quantile,
+                       responseNs, utilization);
+        printf("%d,%.3f,%lld,%.4f,%d\n", copies, us(responseNs), static_cast<long long>(specs[targetIndex].period.count()),
+               utilization, ok ? 1 : 0);
+        fflush(stdout);
+        if (!ok) break;
+        fitting = copies;
+    }
+
+    if (fitting < 0) fprintf(stderr, "%s misses its period at p%g already\n", target, quantile * 100);
+    else if (fitting == maxCopies) fprintf(stderr, "%d or more extra copies of %s fit\n", fitting, grow);
+    else fprintf(stderr, "%d extra copies of %s fit before %s's p%g response exceeds its period\n", fitting, grow,
+                 target, quantile * 100);
+    return 0;
+}
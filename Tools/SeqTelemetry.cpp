@@ -0,0 +1,218 @@
+/*
+ * Watch running Sequencers through their shared-memory telemetry
+ *
+ *   ./SeqTelemetry [--interval-ms 1000] [--once] [--releases N] [shm-name ...]
+ *
+ * Without names, every /dev/shm/sequencer.* segment is watched. Each
+ * refresh prints, per process and service: jobs and job rate since the
+ * last refresh, deadline misses, overruns, exec time and release jitter
+ * (min/avg/max) and, with --releases, the last N releases from the ring.
+ *
+ * Read-only: segments are mapped PROT_READ and copied under their seqlocks,
+ * the Sequencer never notices it is being watched.
+ */
+
+#include "Telemetry.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <map>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+struct Segment
+{
+    std::string name;   // shm name, "/sequencer.<pid>"
+    const TelemetryHeader* header{nullptr};
+    size_t bytes{0};
+};
+
+static long long nowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Map `name` read-only and check it is a layout we understand
+static bool openSegment(const std::string& name, Segment& seg)
+{
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", name.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(TelemetryHeader))
+    {
+        fprintf(stderr, "%s: too small for a telemetry segment\n", name.c_str());
+        close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        fprintf(stderr, "%s: mmap: %s\n", name.c_str(), strerror(errno));
+        return false;
+    }
+
+    auto* header = static_cast<const TelemetryHeader*>(map);
+    size_t needed = sizeof(TelemetryHeader) + size_t(header->serviceCount) * sizeof(TelemetryService);
+    if (header->magic != SEQ_TELEMETRY_MAGIC || header->version != SEQ_TELEMETRY_VERSION ||
+        header->headerSize != sizeof(TelemetryHeader) || header->serviceSize != sizeof(TelemetryService) ||
+        needed > static_cast<size_t>(st.st_size))
+    {
+        fprintf(stderr, "%s: not a version %u telemetry segment\n", name.c_str(), SEQ_TELEMETRY_VERSION);
+        munmap(map, static_cast<size_t>(st.st_size));
+        return false;
+    }
+
+    seg.name = name;
+    seg.header = header;
+    seg.bytes = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+static std::vector<std::string> findSegments()
+{
+    std::vector<std::string> names;
+    DIR* dir = opendir("/dev/shm");
+    if (!dir) return names;
+    while (dirent* entry = readdir(dir))
+    {
+        if (strncmp(entry->d_name, "sequencer.", 10) == 0)
+        {
+            names.push_back(std::string("/") + entry->d_name);
+        }
+    }
+    closedir(dir);
+    return names;
+}
+
+static const char* stateName(uint32_t state)
+{
+    switch (state)
+    {
+    case TELEMETRY_STARTING: return "starting";
+    case TELEMETRY_RUNNING:  return "running";
+    case TELEMETRY_STOPPED:  return "stopped";
+    default:                 return "?";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int intervalMs = 1000;
+    int releases = 0;
+    bool once = false;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--once") == 0) once = true;
+        else if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) intervalMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--releases") == 0 && i + 1 < argc)    releases = atoi(argv[++i]);
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "usage: %s [--interval-ms N] [--once] [--releases N] [shm-name ...]\n", argv[0]);
+            return 2;
+        }
+        else names.push_back(argv[i][0] == '/' ? argv[i] : std::string("/") + argv[i]);
+    }
+    if (intervalMs < 1) intervalMs = 1;
+    if (releases > SEQ_TELEMETRY_RING) releases = SEQ_TELEMETRY_RING;
+
+    bool scan = names.empty();
+    std::map<std::string, Segment> segments;
+    std::map<std::string, long long> lastJobs;  // "<shm>/<service>" -> jobs
+    long long lastNs = nowNs();
+
+    while (true)
+    {
+        // Pick up new processes, drop the ones whose segment is gone
+        if (scan) names = findSegments();
+        for (const std::string& name : names)
+        {
+            if (segments.count(name)) continue;
+            Segment seg;
+            if (openSegment(name, seg)) segments[name] = seg;
+        }
+        for (auto it = segments.begin(); it != segments.end();)
+        {
+            bool alive = kill(it->second.header->pid, 0) == 0 || errno == EPERM;
+            if (!alive || (scan && std::find(names.begin(), names.end(), it->first) == names.end()))
+            {
+                munmap(const_cast<TelemetryHeader*>(it->second.header), it->second.bytes);
+                it = segments.erase(it);
+            }
+            else ++it;
+        }
+
+        long long now = nowNs();
+        double elapsedS = double(now - lastNs) / 1e9;
+        lastNs = now;
+
+        for (auto& [name, seg] : segments)
+        {
+            const TelemetryHeader& header = *seg.header;
+            uint32_t state = std::atomic_ref<uint32_t>(const_cast<uint32_t&>(header.state)).load(std::memory_order_acquire);
+            printf("%s pid=%d %s services=%u\n", name.c_str(), header.pid, stateName(state), header.serviceCount);
+            if (state == TELEMETRY_STARTING) continue;
+
+            auto* entries = reinterpret_cast<const TelemetryService*>(
+                reinterpret_cast<const char*>(seg.header) + sizeof(TelemetryHeader));
+            for (uint32_t i = 0; i < header.serviceCount; i++)
+            {
+                TelemetryService t;
+                if (!telemetryRead(entries[i], t))
+                {
+                    printf("  (entry %u busy)\n", i);
+                    continue;
+                }
+
+                std::string key = name + "/" + t.name;
+                long long previous = lastJobs.count(key) ? lastJobs[key] : t.jobs;
+                lastJobs[key] = t.jobs;
+                double rate = elapsedS > 0 ? double(t.jobs - previous) / elapsedS : 0.0;
+                long long jobs = t.jobs > 0 ? t.jobs : 1;
+
+                printf("  %-20s period=%.3fms jobs=%lld (%.1f/s) misses=%lld overruns=%lld\n",
+                       t.name, t.periodNs / 1e6, static_cast<long long>(t.jobs), rate,
+                       static_cast<long long>(t.deadlineMisses), static_cast<long long>(t.overruns));
+                if (t.jobs == 0) continue;
+                printf("  %-20s exec min/avg/max=%.2f/%.2f/%.2fus  relJitter min/avg/max=%.2f/%.2f/%.2fus\n", "",
+                       t.execMinNs / 1e3, double(t.execTotalNs) / double(jobs) / 1e3, t.execMaxNs / 1e3,
+                       t.releaseJitterMinNs / 1e3, double(t.releaseJitterTotalNs) / double(jobs) / 1e3,
+                       t.releaseJitterMaxNs / 1e3);
+
+                // Newest first
+                long long shown = std::min<long long>(releases, static_cast<long long>(t.ringHead));
+                for (long long r = 0; r < shown; r++)
+                {
+                    const TelemetryRelease& rel = t.ring[(t.ringHead - 1 - r) % SEQ_TELEMETRY_RING];
+                    printf("  %-20s   release=%lld jitter=%.2fus exec=%.2fus%s\n", "",
+                           static_cast<long long>(rel.releaseNs), rel.jitterNs / 1e3, rel.execNs / 1e3,
+                           (rel.flags & TELEMETRY_RELEASE_MISSED) ? " MISSED" : "");
+                }
+            }
+        }
+        if (segments.empty()) printf("no sequencer telemetry segments\n");
+        fflush(stdout);
+
+        if (once) break;
+        usleep(static_cast<useconds_t>(intervalMs) * 1000);
+        printf("\n");
+    }
+    return 0;
+}
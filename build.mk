@@ -0,0 +1,48 @@
+# Build profiles, shared by every Makefile in the tree (included after the
+# Makefile sets its own CXXFLAGS / LDFLAGS).
+#
+#   make                      # BUILD=debug: no optimization, as always
+#   make BUILD=release        # -O2
+#   make BUILD=fast           # -O3
+#   make BUILD=lto            # -O2 + link-time optimization
+#   make pgo                  # (top level) profile-guided: see ../Makefile
+#
+# BUILD=pgo-gen and BUILD=pgo-use are the two halves of `make pgo`. The
+# profiles (*.gcda) are written next to the objects they belong to, so both
+# halves must build the same objects in the same place.
+#
+# Objects depend on a per-profile stamp file, so changing BUILD rebuilds
+# everything instead of mixing objects from two profiles.
+
+BUILD ?= debug
+
+ifeq ($(BUILD),debug)
+PROFILE_FLAGS =
+else ifeq ($(BUILD),release)
+PROFILE_FLAGS = -O2
+else ifeq ($(BUILD),fast)
+PROFILE_FLAGS = -O3
+else ifeq ($(BUILD),lto)
+PROFILE_FLAGS = -O2 -flto=auto
+else ifeq ($(BUILD),pgo-gen)
+# Workers, the timer and the stats threads all run instrumented code
+PROFILE_FLAGS = -O2 -fprofile-generate -fprofile-update=atomic
+else ifeq ($(BUILD),pgo-use)
+# Code the training run never reached keeps plain -O2 (no warning about it)
+PROFILE_FLAGS = -O2 -flto=auto -fprofile-use -fprofile-partial-training -fprofile-correction -Wno-missing-profile
+else
+$(error unknown BUILD=$(BUILD): debug, release, fast, lto, pgo-gen or pgo-use)
+endif
+
+CXXFLAGS += $(PROFILE_FLAGS)
+
+# Archives of LTO objects need the linker plugin's index
+ifneq ($(filter -flto%,$(PROFILE_FLAGS)),)
+AR = gcc-ar
+endif
+
+PROFILE_STAMP = .build-$(BUILD)
+
+$(PROFILE_STAMP):
+	@rm -f .build-*
+	@touch $@